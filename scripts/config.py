@@ -12,10 +12,10 @@ recv_thr_num = 20
 comp_thr_num = 10
 proc_thr_num = 40
 
-# The number of memory blocks that need to be allocated
-#    (bigger than three times of the task number)
+# The memory of the pieces in flight is mem_num * mem_size bytes, cut into
+#    slices of psize and shared by all the tasks; the slices never used at
+#    the same time are not touched unless faulted in when starting
 mem_num = 10
-# The size of each memory (bigger than the block size)
 mem_size = 1 << 26
 
 # The path of config files
@@ -41,6 +41,85 @@ only_print_net_constrain = True
 # The name of the net card (Check this by 'ifconfig')
 eth_name = 'eth0'
 
+# True for sending slices by MSG_ZEROCOPY (needs Linux 4.14 or later)
+zero_copy = False
+
+# The number of parallel connections between two nodes
+stream_num = 1
+# True for assigning slices to the connections by offset, False by task
+stripe_by_offset = False
+
+# The number of epoll threads receiving slices from all the other nodes,
+#     0 for using a blocking thread for each connection
+poll_thr_num = 0
+
+# True for nodes on the same host to transmit through shared memory
+shared_memory = True
+
+# True for limiting the bandwidth inside the program (without root),
+#     False for setting the network interface by wondershaper
+token_bucket = False
+
+# Seconds to wait for the other nodes when starting, 0 for no limit
+connect_timeout = 60
+
+# Tuning of the TCP sockets: disable Nagle's algorithm, acknowledge at once,
+#     cork the header with the content, microseconds of busy polling
+#     (needs CAP_NET_ADMIN), and the socket buffers which hold
+#     sock_buf_pieces slices or 10 ms of link_mbps (0 0 for the default)
+no_delay = True
+quick_ack = False
+cork = False
+busy_poll = 0
+sock_buf_pieces = 0
+link_mbps = 0
+
+# Compression of the slices on the links slower than compress_below_mbps:
+#     codec 0 for none, 1 for LZ4 (make WITH_LZ4=1), 2 for zstd
+#     (make WITH_ZSTD=1); the level of zstd or the acceleration of LZ4
+codec = 0
+codec_level = 1
+compress_below_mbps = 0
+
+# The number of slices which can be in flight from one node to another,
+#     the receiver grants them back after computing, 0 for no limit
+credit_slices = 0
+
+# Pages of the memory: 0 for normal pages, 1 for transparent huge
+#     pages, 2 for huge pages reserved in hugetlbfs (falls back to 1);
+#     True for faulting the pages in when starting;
+#     the NUMA node to place the memory on, -1 for any, -2 for the node of
+#     the net card
+huge_pages = 0
+prefault = False
+numa_node = -1
+
+# The number of tasks a node can be in at the same time, the tasks of the
+#     later groups start once a node is free; 0 for running the groups one
+#     after another. Should be smaller than the receiving threads, and the
+#     memory should hold some blocks for each task
+task_cap = 0
+
+# The cores of the receiving, computing and proceeding threads: a list like
+#     '0-3,8', 'nic' for the cores on the NUMA node of the net card, or '-'
+#     for any core; True for giving each thread one of its cores in turn and
+#     keeping the computing threads off the cores serving the interrupts of
+#     the net card
+recv_cores = '-'
+comp_cores = '-'
+proc_cores = '-'
+isolate_cores = False
+
+# The kernel of the erasure code computation: 'base', 'ssse3', 'avx', 'avx2',
+#     'avx512' or 'gfni' (built with WITH_GFNI=1), or 'auto' for the fastest
+#     one the CPU supports
+rs_kernel = 'auto'
+
+# The blocks lost in each stripe, up to 4: the requestor's and those of the
+#     first nodes left out of the repair. They are repaired together, each
+#     helper reading its block once and sending a partial sum for each
+lost_blocks = 1
+
 # The ip addresses of each nodes (The first one is the master node)
 ips = [('127.0.0.1', 10083),
        ('127.0.0.1', 10084),
@@ -92,6 +171,21 @@ config_format = '''\
 
 {if_only_print_net_constrain}
 {eth_name}
+
+{if_zero_copy}
+{stream_num} {if_stripe_by_offset}
+{poll_thr_num}
+{if_shared_memory}
+{if_token_bucket}
+{connect_timeout}
+{if_no_delay} {if_quick_ack} {if_cork} {busy_poll} {sock_buf_pieces} {link_mbps}
+{codec} {codec_level} {compress_below_mbps}
+{credit_slices}
+{huge_pages} {if_prefault} {numa_node}
+{task_cap}
+{recv_cores} {comp_cores} {proc_cores} {if_isolate_cores}
+{rs_kernel}
+{lost_blocks}
 '''
 
 def write_address_file():
@@ -116,6 +210,15 @@ def write_algorithm_file():
 def write_config_file():
     with open(config_dir + config_file, 'w') as f:
         if_only_print_net_constrain = 1 if only_print_net_constrain else 0
+        if_zero_copy = 1 if zero_copy else 0
+        if_stripe_by_offset = 1 if stripe_by_offset else 0
+        if_shared_memory = 1 if shared_memory else 0
+        if_token_bucket = 1 if token_bucket else 0
+        if_no_delay = 1 if no_delay else 0
+        if_quick_ack = 1 if quick_ack else 0
+        if_cork = 1 if cork else 0
+        if_prefault = 1 if prefault else 0
+        if_isolate_cores = 1 if isolate_cores else 0
         f.write(eval(f"f'''{config_format}'''"))
     with open(config_dir + config_format_file, 'w') as f:
         f.write(config_format)
@@ -6,8 +6,9 @@
 namespace exr {
 
 //Constructor and destructor
-BandwidthSolver::BandwidthSolver(const Name &eth, const bool &if_print)
-    : is_pure_load_(eth == ""), if_print_(if_print),
+BandwidthSolver::BandwidthSolver(const Name &eth, const bool &if_print,
+                                 const bool &pure_load)
+    : is_pure_load_(pure_load || eth == ""), if_print_(if_print),
       bw_num_(0), node_num_(0), cur_(0),
       eth_(eth), reset_cmd_(kResetCmd + eth) {}
 
@@ -66,8 +67,9 @@ Bandwidth* BandwidthSolver::GetBandwidths() {
   return bandwidths_.get();
 }
 
-//Set bandwidth to one of the bandwidth values
-void BandwidthSolver::SetBandwidth(const Count &id, const bool &is_full) {
+//Get one of the bandwidth values
+Bandwidth BandwidthSolver::GetBandwidth(const Count &id,
+                                        const bool &is_full) {
   BwType upload = bandwidths_[id - 1].upload;
   BwType download = bandwidths_[id - 1].download;
 
@@ -78,11 +80,17 @@ void BandwidthSolver::SetBandwidth(const Count &id, const bool &is_full) {
     if (upload < kMinSetBandwidth) upload = kMinSetBandwidth;
     if (download < kMinSetBandwidth) download = kMinSetBandwidth;
   }
+  return {upload, download};
+}
+
+//Set bandwidth to one of the bandwidth values
+void BandwidthSolver::SetBandwidth(const Count &id, const bool &is_full) {
+  auto bw = GetBandwidth(id, is_full);
 
   ResetBandwidth();
   std::stringstream fmt;
-  fmt << kSetCmd << eth_ << kUploadPara << upload
-                         << kDownloadPara << download;
+  fmt << kSetCmd << eth_ << kUploadPara << bw.upload
+                         << kDownloadPara << bw.download;
   if (if_print_) {
     std::cout << cur_ << ": " << fmt.str() << std::endl;
   } else {
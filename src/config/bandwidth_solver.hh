@@ -15,7 +15,9 @@ using CmdType = std::string;
 class BandwidthSolver
 {
  public:
-  BandwidthSolver(const Name &eth_name, const bool &if_print);
+  //The bandwidths are only loaded, not set to the net card, if pure_load
+  BandwidthSolver(const Name &eth_name, const bool &if_print,
+                  const bool &pure_load = false);
   ~BandwidthSolver();
 
   void Open(const Path &path);
@@ -25,6 +27,8 @@ class BandwidthSolver
   void SetFull(const Count &id);
   Bandwidth* GetBandwidths();
 
+  //The bandwidth to set to a node, in Kbps
+  Bandwidth GetBandwidth(const Count &id, const bool &is_full);
   void SetBandwidth(const Count &id, const bool &is_full);
   void ResetBandwidth();
 
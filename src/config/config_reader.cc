@@ -1,9 +1,15 @@
 #include "config/config_reader.hh"
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <string>
+
+#include "util/cpu_topology.hh"
+#include "util/memory_pool.hh"
+#include "util/types.hh"
 
 namespace exr {
 
@@ -37,6 +43,101 @@ void ConfigReader::Load(const Path &path, const Count &id) {
   Count ifp;
   config_file >> ifp >> eth_;
   if_print_ = (ifp == 1);
+
+  //Options of data access, the defaults are kept if not given
+  access_options_ = AccessOptions();
+  Count zero_copy = 0, stream_num = 1, by_offset = 0;
+  config_file >> zero_copy >> stream_num >> by_offset;
+  access_options_.zero_copy = (zero_copy == 1);
+  access_options_.stream_num = stream_num > 0 ? stream_num : 1;
+  access_options_.stripe_by_offset = (by_offset == 1);
+
+  //Threads receiving by epoll, 0 for a blocking thread per connection
+  poll_thr_num_ = 0;
+  config_file >> poll_thr_num_;
+
+  //Nodes on the same host talk through shared memory if enabled
+  Count shm = 0;
+  config_file >> shm;
+  access_options_.shared_memory = (shm == 1);
+
+  //Bandwidth is limited by the program itself or by wondershaper
+  Count tb = 0;
+  config_file >> tb;
+  access_options_.token_bucket = (tb == 1);
+
+  //Seconds to wait for the other nodes when connecting
+  config_file >> access_options_.connect_timeout;
+
+  //Socket tuning, the buffers hold some pieces or the traffic of a while
+  auto &sp = access_options_.socket;
+  Count no_delay = 0, quick_ack = 0, cork = 0, buf_pieces = 0;
+  DataSize link_mbps = 0;
+  config_file >> no_delay >> quick_ack >> cork >> sp.busy_poll
+              >> buf_pieces >> link_mbps;
+  sp.no_delay = (no_delay == 1);
+  sp.quick_ack = (quick_ack == 1);
+  sp.cork = (cork == 1);
+  sp.buf_size = std::max<DataSize>(buf_pieces * psize_,
+                                   link_mbps * 125000 * kSockBufTime);
+
+  //Compression of the pieces on the links slower than the Mbps given
+  BwType compress_below_mbps = 0;
+  config_file >> access_options_.codec >> access_options_.codec_level
+              >> compress_below_mbps;
+  access_options_.compress_below = compress_below_mbps * 1000;
+
+  //Slices in flight on each link, granted back by the receiver
+  config_file >> access_options_.credit_slices;
+
+  //Pages of the memory pool and the NUMA node to place it on
+  memory_options_ = MemoryOptions();
+  Count prefault = 0;
+  config_file >> memory_options_.huge_pages >> prefault
+              >> memory_options_.numa_node;
+  memory_options_.prefault = (prefault == 1);
+  if (memory_options_.numa_node == kNicNode)
+    memory_options_.numa_node = MemoryPool::NicNode(eth_);
+
+  //Tasks a node can be in at the same time, 0 for one group at a time
+  task_cap_ = 0;
+  config_file >> task_cap_;
+
+  //Cores of the receiving, computing and proceeding threads, and whether
+  //    each thread has a core of its own, with computing kept off the
+  //    cores serving the interrupts of the net card
+  std::string recv_cores = "-", comp_cores = "-", proc_cores = "-";
+  Count isolate = 0;
+  config_file >> recv_cores >> comp_cores >> proc_cores >> isolate;
+  CpuTopology topo(eth_);
+  thread_options_ = ThreadOptions();
+  thread_options_.recv.cores = topo.ParseCores(recv_cores);
+  thread_options_.comp.cores = topo.ParseCores(comp_cores);
+  thread_options_.proc.cores = topo.ParseCores(proc_cores);
+  if (isolate == 1) {
+    topo.AvoidIrqs(thread_options_.comp.cores);
+    thread_options_.recv.isolate = true;
+    thread_options_.comp.isolate = true;
+    thread_options_.proc.isolate = true;
+  }
+
+  //Kernel of the erasure code computation, "auto" for the fastest one
+  rs_kernel_ = "auto";
+  config_file >> rs_kernel_;
+
+  //Lost blocks of each stripe, repaired together, at most kMaxLanes
+  lost_blocks_ = 1;
+  config_file >> lost_blocks_;
+  if (lost_blocks_ == 0) {
+    std::cerr << "Lost blocks should be at least 1" << std::endl;
+    exit(-1);
+  }
+  if (lost_blocks_ > kMaxLanes) {
+    std::cerr << "Lost blocks " << lost_blocks_ << " are more than "
+              << kMaxLanes << ", only " << kMaxLanes << " are repaired"
+              << std::endl;
+    lost_blocks_ = kMaxLanes;
+  }
   config_file.close();
 }
 
@@ -63,4 +164,24 @@ const Path& ConfigReader::get_write_file() { return write_file_; }
 bool ConfigReader::get_if_print() { return if_print_; }
 const Name& ConfigReader::get_eth_name() { return eth_; }
 
+const AccessOptions& ConfigReader::get_access_options() {
+  return access_options_;
+}
+Count ConfigReader::get_poll_thr_num() { return poll_thr_num_; }
+
+const MemoryOptions& ConfigReader::get_memory_options() {
+  return memory_options_;
+}
+
+Count ConfigReader::get_task_cap() { return task_cap_; }
+const ThreadOptions& ConfigReader::get_thread_options() {
+  return thread_options_;
+}
+const Name& ConfigReader::get_rs_kernel() { return rs_kernel_; }
+Count ConfigReader::get_lost_blocks() { return lost_blocks_; }
+
+//Static values
+const double ConfigReader::kSockBufTime = 0.01;
+const int ConfigReader::kNicNode = -2;
+
 } // namespace exr
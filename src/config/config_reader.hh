@@ -37,6 +37,14 @@ class ConfigReader
   bool get_if_print();
   const Name& get_eth_name();
 
+  const AccessOptions& get_access_options();
+  Count get_poll_thr_num();
+  const MemoryOptions& get_memory_options();
+  Count get_task_cap();
+  const ThreadOptions& get_thread_options();
+  const Name& get_rs_kernel();
+  Count get_lost_blocks();
+
   //ConfigReader is neither copyable nor movable
   ConfigReader(const ConfigReader&) = delete;
   ConfigReader& operator=(const ConfigReader&) = delete;
@@ -64,6 +72,17 @@ class ConfigReader
 
   bool if_print_;
   Name eth_;
+
+  AccessOptions access_options_;
+  Count poll_thr_num_;
+  MemoryOptions memory_options_;
+  Count task_cap_;
+  ThreadOptions thread_options_;
+  Name rs_kernel_;
+  Count lost_blocks_;
+
+  static const double kSockBufTime; //Seconds of traffic in socket buffers
+  static const int kNicNode;        //Place the memory near the interface
 };
 
 } // namespace exr
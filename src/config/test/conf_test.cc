@@ -1,6 +1,7 @@
 #include <iostream>
 
 #include "config/config_reader.hh"
+#include "util/cpu_topology.hh"
 
 int main()
 {
@@ -25,6 +26,43 @@ int main()
             << "data read file: " << cr.get_read_file() << std::endl
             << "data write file: " << cr.get_write_file() << std::endl
             << "if print constrain: " << cr.get_if_print() << std::endl
-            << "eth name: " << cr.get_eth_name() << std::endl;
+            << "eth name: " << cr.get_eth_name() << std::endl
+            << "zero copy: " << cr.get_access_options().zero_copy
+                             << std::endl
+            << "stream number: " << cr.get_access_options().stream_num
+                                 << std::endl
+            << "stripe by offset: "
+            << cr.get_access_options().stripe_by_offset << std::endl
+            << "poll thread number: " << cr.get_poll_thr_num() << std::endl
+            << "shared memory: " << cr.get_access_options().shared_memory
+                                 << std::endl
+            << "token bucket: " << cr.get_access_options().token_bucket
+                                << std::endl
+            << "connect timeout: "
+            << cr.get_access_options().connect_timeout << std::endl
+            << "socket: no delay " << cr.get_access_options().socket.no_delay
+            << ", quick ack " << cr.get_access_options().socket.quick_ack
+            << ", cork " << cr.get_access_options().socket.cork
+            << ", busy poll " << cr.get_access_options().socket.busy_poll
+            << ", buffer " << cr.get_access_options().socket.buf_size
+            << std::endl
+            << "codec: " << cr.get_access_options().codec
+            << ", level " << cr.get_access_options().codec_level
+            << ", below " << cr.get_access_options().compress_below
+            << " Kbps" << std::endl
+            << "credit slices: " << cr.get_access_options().credit_slices
+            << std::endl
+            << "memory: huge pages " << cr.get_memory_options().huge_pages
+            << ", prefault " << cr.get_memory_options().prefault
+            << ", numa node " << cr.get_memory_options().numa_node
+            << std::endl
+            << "task cap: " << cr.get_task_cap() << std::endl;
+  auto &to = cr.get_thread_options();
+  for (auto role : {&to.recv, &to.comp, &to.proc})
+    std::cout << role->name << " cores: "
+              << exr::CpuTopology::ListCores(role->cores)
+              << (role->isolate ? " isolated" : "") << std::endl;
+  std::cout << "rs kernel: " << cr.get_rs_kernel() << std::endl
+            << "lost blocks: " << cr.get_lost_blocks() << std::endl;
   return 0;
 }
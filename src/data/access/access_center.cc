@@ -1,47 +1,182 @@
 #include "data/access/access_center.hh"
 
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "data/access/connection_solver.hh"
+#include "data/access/shm_solver.hh"
 #include "data/access/socket_solver.hh"
 
 namespace exr {
 
 //Constructor and destructor
-AccessCenter::AccessCenter(const Count &id, const Count &total)
-    : id_(id), total_(total), tis(new pTI[total]) {}
+AccessCenter::AccessCenter(const Count &id, const Count &total,
+                           const AccessOptions &options)
+    : id_(id), total_(total), options_(options),
+      compressor_(options.codec, options.codec_level) {
+  if (options_.stream_num == 0) options_.stream_num = 1;
+  tis = TIList(new pTI[total * options_.stream_num]);
+  stats_ = std::make_unique<Stats[]>(total * options_.stream_num);
+  accepts_ = std::make_unique<std::atomic<bool>[]>(total);
+  compress_ = std::make_unique<std::atomic<bool>[]>(total);
+  decoders_ = std::make_unique<std::unique_ptr<Compressor>[]>(total);
+  ctrls_ = std::make_unique<std::unique_ptr<ControlChannel>[]>(total);
+  for (Count i = 0; i < total; ++i) {
+    accepts_[i] = false;
+    compress_[i] = false;
+  }
+}
 
-AccessCenter::~AccessCenter() { if (acc_) acc_.close(); }
+AccessCenter::~AccessCenter() {
+  if (gate_) gate_->Close();
+  for (Count i = 0; i < total_; ++i)
+    if (ctrls_[i]) ctrls_[i]->Close();
+  if (acc_) acc_.close();
+}
 
 //Connect to others
 void AccessCenter::Connect(const IPAddressList &ip_addresses) {
   //Start listening and receive connection from those whose ids are bigger
   std::thread receive_thread;
   if (id_ != total_ - 1) {
-    acc_ = sockpp::tcp_acceptor(ip_addresses[id_].port);
+    acc_ = sockpp::tcp_acceptor(ip_addresses[id_].port, SOMAXCONN);
     if (!acc_) {
       std::cerr << acc_.last_error_str() << std::endl;
       exit(-1);
     }
+    //Accepted sockets get the buffer sizes of the listener
+    if (options_.socket.buf_size > 0) {
+      SocketProfile profile;
+      profile.buf_size = options_.socket.buf_size;
+      SocketSolver::Tune(acc_.handle(), profile);
+    }
     receive_thread = std::thread([&] {
-      Count client_id;
-      for (Count i = id_ + 1; i < total_; ++i) {
-        pTI ds(new SocketSolver(acc_.accept()));
-        ds->Receive(sizeof(client_id), &client_id);
-        tis[client_id] = std::move(ds);
+      //Each accepted connection does its handshake in its own thread
+      std::vector<std::thread> handshakes;
+      Count conn_num = (total_ - id_ - 1) * (StreamNum_(id_ + 1) + 1);
+      for (Count i = 0; i < conn_num; ++i) {
+        WaitForClient_();
+        auto sock = acc_.accept();
+        handshakes.emplace_back([&](sockpp::tcp_socket sock) {
+          Count client_id, stream;
+          std::unique_ptr<SocketSolver> ss(
+              new SocketSolver(std::move(sock), options_));
+          ss->Receive(sizeof(client_id), &client_id);
+          ss->Receive(sizeof(stream), &stream);
+          NegotiateCodec_(*ss, client_id, stream == 0);
+          if (stream == StreamNum_(client_id))
+            ctrls_[client_id] = std::make_unique<ControlChannel>(
+                std::move(ss));
+          else
+            tis[Index_(client_id, stream)] =
+                Wrap_(std::move(ss), false, true);
+        }, std::move(sock));
       }
+      for (auto &t : handshakes) t.join();
     });
   }
 
-  //Connect to those whose ids are smaller
+  //Connect to those whose ids are smaller, all at the same time,
+  //    the connection after the streams is the control connection
+  std::vector<std::thread> connectors;
   for (Count i = 0; i < id_; ++i) {
-    tis[i] = pTI(new ConnectionSolver(ip_addresses[i]));
-    tis[i]->Send(sizeof(id_), &id_);
+    bool local = options_.shared_memory && IsLocal_(ip_addresses[i]);
+    for (Count s = 0; s <= StreamNum_(i); ++s) {
+      connectors.emplace_back([&, i, s, local]() mutable {
+        std::unique_ptr<SocketSolver> ss(
+            new ConnectionSolver(ip_addresses[i], options_));
+        ss->Send(sizeof(id_), &id_);
+        ss->Send(sizeof(s), &s);
+        NegotiateCodec_(*ss, i, s == 0);
+        if (s == StreamNum_(i))
+          ctrls_[i] = std::make_unique<ControlChannel>(std::move(ss));
+        else
+          tis[Index_(i, s)] = Wrap_(std::move(ss), true, local);
+      });
+    }
   }
 
   //Wait for receiving
+  for (auto &t : connectors) t.join();
   if (id_ != total_ - 1) receive_thread.join();
+
+  //Barrier: the master returns after all the nodes have connected
+  if (id_ == 0) {
+    Count ready_id;
+    for (Count i = 1; i < total_; ++i) {
+      Receive(i, sizeof(ready_id), &ready_id);
+      if (ready_id != i) {
+        std::cerr << "Wrong ready message from " << i << std::endl;
+        exit(-1);
+      }
+    }
+  } else {
+    Send(0, sizeof(id_), &id_);
+  }
+  StartControl_();
+  connected_time_ = std::chrono::steady_clock::now();
+}
+
+//The credits of the flow control are granted on the control connections
+//    between the nodes, the master is not limited
+void AccessCenter::StartControl_() {
+  if (options_.credit_slices > 0) {
+    gate_ = std::make_unique<CreditGate>(total_, options_.credit_slices,
+        [&](const Count &peer_id, const Count &credits) {
+      ctrls_[peer_id]->Post(ControlType::kCredit, &credits, sizeof(credits));
+    });
+  }
+  for (Count i = 0; i < total_; ++i) {
+    if (!ctrls_[i]) continue;
+    if (gate_ && i != 0 && id_ != 0) {
+      ctrls_[i]->On(ControlType::kCredit,
+                    [&, i](const ControlChannel::Message &msg) {
+        gate_->Add(i, *reinterpret_cast<const Count*>(msg.data()));
+      });
+      gate_->Open(i);
+    }
+    ctrls_[i]->Run();
+  }
+}
+
+//Wait until a connection can be accepted, no longer than the timeout
+void AccessCenter::WaitForClient_() {
+  if (options_.connect_timeout == 0) return;
+  struct pollfd pfd{acc_.handle(), POLLIN, 0};
+  int res;
+  do {
+    res = poll(&pfd, 1, options_.connect_timeout * 1000);
+  } while (res < 0 && errno == EINTR);
+  if (res <= 0) {
+    std::cerr << "Node " << id_ << " timed out waiting for connections"
+              << std::endl;
+    exit(-1);
+  }
+}
+
+//Both sides send their offers before receiving, only the offer on the first
+//    connection is kept as the others are the same
+void AccessCenter::NegotiateCodec_(SocketSolver &ss, const Count &peer_id,
+                                   const bool &first) {
+  CodecOffer offer{compressor_.get_codec(), Compressor::SupportedCodecs()};
+  ss.Send(sizeof(offer), &offer);
+  ss.Receive(sizeof(offer), &offer);
+  if (!first) return;
+  accepts_[peer_id] = (offer.supported & (1 << compressor_.get_codec()));
+  if (offer.codec != Compressor::kNone &&
+      (Compressor::SupportedCodecs() & (1 << offer.codec)))
+    decoders_[peer_id] = std::make_unique<Compressor>(offer.codec, 0);
 }
 
 //Send and Receive
@@ -51,16 +186,267 @@ void AccessCenter::Send(const Count &tar_id,
     std::cerr << "Cannot send data to local!!!" << std::endl;
     exit(-1);
   }
-  tis[tar_id]->Send(size, buf);
+  auto idx = Index_(tar_id, 0);
+  auto ts = std::chrono::steady_clock::now();
+  if (tar_id != 0) upload_.Consume(size);
+  tis[idx]->Send(size, buf);
+  stats_[idx].send_us += std::chrono::duration_cast<
+      std::chrono::microseconds>(std::chrono::steady_clock::now() - ts)
+      .count();
+  stats_[idx].sent += size;
 }
 
-void AccessCenter::Receive(const Count &src_id,
-                           const DataSize &size, void *buf) {
+void AccessCenter::SendV(const Count &tar_id, struct iovec *iov,
+                         const Count &n, const Count &stream) {
+  if (tar_id == id_) {
+    std::cerr << "Cannot send data to local!!!" << std::endl;
+    exit(-1);
+  }
+  auto idx = Index_(tar_id, stream);
+  DataSize size = 0;
+  for (Count i = 0; i < n; ++i) size += iov[i].iov_len;
+  auto ts = std::chrono::steady_clock::now();
+  if (tar_id != 0) upload_.Consume(size);
+  tis[idx]->SendV(iov, n);
+  stats_[idx].send_us += std::chrono::duration_cast<
+      std::chrono::microseconds>(std::chrono::steady_clock::now() - ts)
+      .count();
+  stats_[idx].sent += size;
+}
+
+void AccessCenter::Receive(const Count &src_id, const DataSize &size,
+                           void *buf, const Count &stream) {
   if (src_id == id_) {
     std::cerr << "Cannot receive from local!!!" << std::endl;
     exit(-1);
   }
-  tis[src_id]->Receive(size, buf);
+  tis[Index_(src_id, stream)]->Receive(size, buf);
+  CountReceived(src_id, stream, size);
+}
+
+void AccessCenter::SendPiece(const Count &tar_id, PieceHeader header,
+                             void *buf, const Count &stream) {
+  SendPiece_(tar_id, header, buf, stream, compress_[tar_id]);
+}
+
+//Compressed pieces are sent one by one, with flow control the credits of
+//    the pieces in one message are taken at once
+void AccessCenter::SendPieces(const Count &tar_id,
+                              const PieceHeader *headers, void *const *bufs,
+                              const Count &n, const Count &stream) {
+  //The link may be set by the control thread meanwhile
+  if (compress_[tar_id]) {
+    for (Count i = 0; i < n; ++i)
+      SendPiece_(tar_id, headers[i], bufs[i], stream, true);
+    return;
+  }
+
+  static thread_local std::vector<PieceHeader> hs;
+  static thread_local std::vector<struct iovec> iov;
+  Count max_n = gate_ ? gate_->get_max_acquire() : n;
+  for (Count i = 0; i < n; i += max_n) {
+    auto m = std::min<Count>(max_n, n - i);
+    if (gate_) gate_->Acquire(tar_id, m);
+    hs.assign(headers + i, headers + i + m);
+    iov.resize(m * 2);
+    for (Count j = 0; j < m; ++j) {
+      hs[j].length = 0;
+      iov[j * 2] = {&hs[j], sizeof(PieceHeader)};
+      iov[j * 2 + 1] = {bufs[i + j], static_cast<size_t>(hs[j].size)};
+    }
+    SendV(tar_id, iov.data(), m * 2, stream);
+  }
+}
+
+//A piece is sent with the header and the content together,
+//    the header is copied as the iovec may be changed by sending
+void AccessCenter::SendPiece_(const Count &tar_id, PieceHeader header,
+                              void *buf, const Count &stream,
+                              const bool &compress) {
+  if (gate_) gate_->Acquire(tar_id);
+
+  //The compressed content is sent only if it is smaller
+  static thread_local std::vector<BufUnit> packed;
+  header.length = 0;
+  if (compress && header.size > 0) {
+    packed.resize(compressor_.Bound(header.size));
+    auto length = compressor_.Compress(static_cast<BufUnit*>(buf),
+                                       header.size, packed.data());
+    if (length > 0 && length < header.size) {
+      header.length = length;
+      buf = packed.data();
+    }
+  }
+
+  struct iovec iov[2] = {{&header, sizeof(header)},
+      {buf, static_cast<size_t>(header.length > 0 ? header.length
+                                                  : header.size)}};
+  SendV(tar_id, iov, 2, stream);
+  //The buffer of the compressed content is reused by the next piece
+  if (header.length > 0 && options_.zero_copy)
+    tis[Index_(tar_id, stream)]->Flush();
+}
+
+void AccessCenter::ReceiveContent(const Count &src_id,
+                                  const PieceHeader &header, void *buf,
+                                  const Count &stream) {
+  if (header.length == 0) {
+    Receive(src_id, header.size, buf, stream);
+    return;
+  }
+  static thread_local std::vector<BufUnit> packed;
+  packed.resize(header.length);
+  Receive(src_id, header.length, packed.data(), stream);
+  Unpack(src_id, header, packed.data(), static_cast<BufUnit*>(buf));
 }
 
+void AccessCenter::Unpack(const Count &src_id, const PieceHeader &header,
+                          const BufUnit *wire, BufUnit *buf) {
+  if (!decoders_[src_id] ||
+      !decoders_[src_id]->Decompress(wire, header.length, buf, header.size)) {
+    std::cerr << "Cannot decompress the piece at " << header.offset
+              << " from " << src_id << std::endl;
+    exit(-1);
+  }
+}
+
+ControlChannel& AccessCenter::Control(const Count &id) {
+  if (!ctrls_[id]) {
+    std::cerr << "No control connection with " << id << std::endl;
+    exit(-1);
+  }
+  return *ctrls_[id];
+}
+
+Traffic AccessCenter::GetTraffic() {
+  Traffic traffic{0, 0};
+  for (Count i = 0; i < total_ * options_.stream_num; ++i) {
+    traffic.sent += stats_[i].sent;
+    traffic.received += stats_[i].received;
+  }
+  return traffic;
+}
+
+void AccessCenter::ReleaseCredit(const Count &src_id) {
+  if (gate_) gate_->Release(src_id);
+}
+
+void AccessCenter::CountReceived(const Count &src_id, const Count &stream,
+                                 const DataSize &size) {
+  stats_[Index_(src_id, stream)].received += size;
+  if (src_id != 0) download_.Consume(size);
+}
+
+void AccessCenter::Flush(const Count &tar_id) {
+  if (tar_id == id_) return;
+  for (Count s = 0; s < (tar_id == 0 ? 1 : options_.stream_num); ++s)
+    tis[Index_(tar_id, s)]->Flush();
+}
+
+bool AccessCenter::is_zero_copy() { return options_.zero_copy; }
+bool AccessCenter::is_token_bucket() { return options_.token_bucket; }
+
+int AccessCenter::GetHandle(const Count &id, const Count &stream) {
+  if (id == id_ || (id == 0 && stream > 0)) return -1;
+  return tis[Index_(id, stream)]->get_handle();
+}
+
+//Pieces are assigned by task, or by offset (the piece index) if required
+Count AccessCenter::ChooseStream(const Count &task_id,
+                                 const DataSize &offset,
+                                 const DataSize &size) {
+  if (options_.stream_num == 1) return 0;
+  if (options_.stripe_by_offset && size > 0)
+    return (offset / size) % options_.stream_num;
+  return task_id % options_.stream_num;
+}
+
+Count AccessCenter::get_stream_num() { return options_.stream_num; }
+
+//Kbps to bytes per second, the burst allows a short period of traffic
+void AccessCenter::SetBandwidth(const Bandwidth &bw) {
+  double up = bw.upload * 125.0, down = bw.download * 125.0;
+  upload_.SetRate(up, std::max<DataSize>(up * kBurstTime, kMinBurst));
+  download_.SetRate(down, std::max<DataSize>(down * kBurstTime, kMinBurst));
+}
+
+void AccessCenter::SetLinkBandwidth(const Count &tar_id, const BwType &bw) {
+  compress_[tar_id] = compressor_.get_codec() != Compressor::kNone &&
+                      accepts_[tar_id] && bw > 0 &&
+                      bw < options_.compress_below;
+}
+
+//Print the traffic of each connection since connected
+void AccessCenter::ShowStats() {
+  double duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - connected_time_).count();
+  std::cout << "Traffic of node " << id_ << " in " << duration / 1e6
+            << " s:" << std::endl;
+  for (Count i = 0; i < total_; ++i) {
+    for (Count s = 0; s < options_.stream_num; ++s) {
+      auto &st = stats_[Index_(i, s)];
+      if (st.sent == 0 && st.received == 0) continue;
+      double sent_mb = st.sent / 1e6, recv_mb = st.received / 1e6;
+      std::cout << "  node " << i << " stream " << s << ": sent "
+                << sent_mb << " MB";
+      if (st.send_us > 0)
+        std::cout << " (" << sent_mb * 1e6 / st.send_us << " MB/s busy)";
+      std::cout << ", received " << recv_mb << " MB ("
+                << recv_mb * 1e6 / duration << " MB/s)" << std::endl;
+    }
+  }
+}
+
+Count AccessCenter::Index_(const Count &id, const Count &stream) {
+  return id * options_.stream_num + stream;
+}
+
+//The master has a single stream with each node
+Count AccessCenter::StreamNum_(const Count &id) {
+  return id == 0 || id_ == 0 ? 1 : options_.stream_num;
+}
+
+AccessCenter::pTI AccessCenter::Wrap_(std::unique_ptr<SocketSolver> ss,
+                                      const bool &offer,
+                                      const bool &local) {
+  std::unique_ptr<ShmSolver> shm;
+  if (offer)
+    shm = ShmSolver::Offer(ss, local);
+  else
+    shm = ShmSolver::Answer(ss, options_.shared_memory);
+  if (shm) return pTI(std::move(shm));
+
+  return pTI(std::move(ss));
+}
+
+//Loopback addresses and the addresses of the interfaces are local
+bool AccessCenter::IsLocal_(const IPAddress &ip_ad) {
+  struct addrinfo hints, *res = nullptr;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(ip_ad.host.c_str(), nullptr, &hints, &res) != 0)
+    return false;
+  struct ifaddrs *ifs = nullptr;
+  if (getifaddrs(&ifs) != 0) ifs = nullptr;
+
+  bool local = false;
+  for (auto ai = res; ai && !local; ai = ai->ai_next) {
+    auto addr = reinterpret_cast<struct sockaddr_in*>(ai->ai_addr)->sin_addr;
+    if ((ntohl(addr.s_addr) >> 24) == 127) local = true;
+    for (auto ifa = ifs; ifa && !local; ifa = ifa->ifa_next) {
+      if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET) continue;
+      auto ifad = reinterpret_cast<struct sockaddr_in*>(ifa->ifa_addr);
+      local = (ifad->sin_addr.s_addr == addr.s_addr);
+    }
+  }
+  if (ifs) freeifaddrs(ifs);
+  freeaddrinfo(res);
+  return local;
+}
+
+//Static values
+const double AccessCenter::kBurstTime = 0.005;
+const DataSize AccessCenter::kMinBurst = 65536;
+
 } // namespace exr
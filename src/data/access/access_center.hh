@@ -1,28 +1,92 @@
 #ifndef EXR_DATA_ACCESS_ACCESSCENTER_HH_
 #define EXR_DATA_ACCESS_ACCESSCENTER_HH_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 
 #include "sockpp/tcp_acceptor.h"
 
+#include "data/access/control_channel.hh"
+#include "data/access/credit_gate.hh"
+#include "data/access/socket_solver.hh"
 #include "data/access/transmit_interface.hh"
+#include "util/compressor.hh"
+#include "util/token_bucket.hh"
 #include "util/typedef.hh"
+#include "util/types.hh"
 
 namespace exr {
 
-/* A controller that can send and receive data with other controllers */
+/* A controller that can send and receive data with other controllers,
+ * there are stream_num connections to each node except the master(0) */
 class AccessCenter
 {
  public:
-  AccessCenter(const Count &id, const Count &total);
+  AccessCenter(const Count &id, const Count &total,
+               const AccessOptions &options = AccessOptions());
   ~AccessCenter();
 
-  //Connect to others
+  //Connect to others in parallel, the master returns only after every
+  //    node has connected to all the others
   void Connect(const IPAddressList &ip_addresses);
+  //The connection of control messages with a node, apart from the data
+  ControlChannel& Control(const Count &id);
 
-  //Send and Receive
+  //Send and Receive, using the first connection if stream is not given
   void Send(const Count &tar_id, const DataSize &size, void *buf);
-  void Receive(const Count &src_id, const DataSize &size, void *buf);
+  void SendV(const Count &tar_id, struct iovec *iov, const Count &n,
+             const Count &stream = 0);
+  void Receive(const Count &src_id, const DataSize &size, void *buf,
+               const Count &stream = 0);
+  //Send a piece, the header followed by the content,
+  //    the content is compressed if the link is slow
+  void SendPiece(const Count &tar_id, PieceHeader header, void *buf,
+                 const Count &stream = 0);
+  //Send n pieces to the same node in one message, each is received as
+  //    if sent by SendPiece
+  void SendPieces(const Count &tar_id, const PieceHeader *headers,
+                  void *const *bufs, const Count &n, const Count &stream = 0);
+  //Receive the content of a piece sent by SendPiece into buf
+  void ReceiveContent(const Count &src_id, const PieceHeader &header,
+                      void *buf, const Count &stream = 0);
+  //Decompress the content of a piece received as it is on the wire
+  void Unpack(const Count &src_id, const PieceHeader &header,
+              const BufUnit *wire, BufUnit *buf);
+  //A piece sent by a node has been consumed, with flow control on
+  //    (credit_slices > 0) the node can send one more piece
+  void ReleaseCredit(const Count &src_id);
+
+  //Data received without Receive, e.g. by polling, is counted here
+  void CountReceived(const Count &src_id, const Count &stream,
+                     const DataSize &size);
+  //Wait until the sent buffers can be reused
+  void Flush(const Count &tar_id);
+  //Whether the sent buffers are still in use until Flush
+  bool is_zero_copy();
+  //Whether the traffic is limited by the token buckets
+  bool is_token_bucket();
+  //The file descriptor of a connection for polling, -1 if not available
+  int GetHandle(const Count &id, const Count &stream);
+
+  //Choose the connection of a piece,
+  //    the sender and the receiver get the same result
+  Count ChooseStream(const Count &task_id, const DataSize &offset,
+                     const DataSize &size);
+  Count get_stream_num();
+
+  //Limit the traffic with other nodes (not the master) in Kbps,
+  //    0 for no limit
+  void SetBandwidth(const Bandwidth &bw);
+  //Compress the pieces to a node if the link to it is slower than
+  //    compress_below (Kbps) and both the nodes have the codec
+  void SetLinkBandwidth(const Count &tar_id, const BwType &bw);
+
+  //Print the traffic of each connection
+  void ShowStats();
+  //Total traffic of the data connections
+  Traffic GetTraffic();
 
   //AccessCenter is neither copyable nor movable
   AccessCenter(const AccessCenter&) = delete;
@@ -31,12 +95,63 @@ class AccessCenter
  private:
   Count id_; //this ConnectionCenter's id
   Count total_; //total number of candidates
+  AccessOptions options_; //options of the connections
   sockpp::tcp_acceptor acc_; //socket acceptor
 
-  //Sockets and Connections
+  //Sockets and Connections, indexed by id * stream_num + stream
   using pTI = std::unique_ptr<TransmitInterface>;
   using TIList = std::unique_ptr<pTI[]>;
   TIList tis;
+  //Control connections, indexed by id
+  std::unique_ptr<std::unique_ptr<ControlChannel>[]> ctrls_;
+  //Flow control of the pieces, nullptr if not used
+  std::unique_ptr<CreditGate> gate_;
+
+  //Traffic of each connection
+  struct Stats {
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> received;
+    std::atomic<uint64_t> send_us; //Time spent in sending
+  };
+  std::unique_ptr<Stats[]> stats_;
+  std::chrono::steady_clock::time_point connected_time_;
+
+  //Shapers of the node's traffic
+  TokenBucket upload_;
+  TokenBucket download_;
+
+  //Compression, negotiated with each node when connecting
+  struct CodecOffer {
+    Count codec;       //Codec used to send
+    uint8_t supported; //Codecs can be decompressed
+  };
+  Compressor compressor_;
+  //Whether a node can decompress, and whether to compress to a node,
+  //    changed by the control thread while sending
+  std::unique_ptr<std::atomic<bool>[]> accepts_;
+  std::unique_ptr<std::atomic<bool>[]> compress_;
+  std::unique_ptr<std::unique_ptr<Compressor>[]> decoders_;
+
+  Count Index_(const Count &id, const Count &stream);
+  //Number of data connections with a node
+  Count StreamNum_(const Count &id);
+  void WaitForClient_();
+  void StartControl_();
+  //Exchange the codecs on the first connection with a node
+  void NegotiateCodec_(SocketSolver &ss, const Count &peer_id,
+                       const bool &first);
+  //Send a piece, compressed if compress is set
+  void SendPiece_(const Count &tar_id, PieceHeader header, void *buf,
+                  const Count &stream, const bool &compress);
+  //Choose the transmission backend for a connected socket,
+  //    shared memory is tried first by a handshake on the socket
+  pTI Wrap_(std::unique_ptr<SocketSolver> ss, const bool &offer,
+            const bool &local);
+  //Whether an address belongs to this host
+  static bool IsLocal_(const IPAddress &ip_ad);
+
+  static const double kBurstTime;
+  static const DataSize kMinBurst;
 };
 
 } // namespace exr
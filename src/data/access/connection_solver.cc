@@ -1,25 +1,39 @@
 #include "data/access/connection_solver.hh"
 
+#include <chrono>
+#include <iostream>
 #include <thread>
 
 namespace exr {
 
-ConnectionSolver::ConnectionSolver(const IPAddress &ip_ad) {
-  //Connect to the server
-  while (!conn_.connect(sockpp::inet_address(ip_ad.host, ip_ad.port)))
-    std::this_thread::yield();
-}
+ConnectionSolver::ConnectionSolver(const IPAddress &ip_ad,
+                                   const AccessOptions &options)
+    : SocketSolver(Connect_(ip_ad, options.connect_timeout), options) {}
 
-ConnectionSolver::~ConnectionSolver() { conn_.close(); }
+ConnectionSolver::~ConnectionSolver() = default;
 
-//Send messages to another host
-void ConnectionSolver::Send(const DataSize &size, void *buf) {
-  conn_.write_n(buf, size);
+//Connect to the server, which may not be listening yet
+sockpp::tcp_socket ConnectionSolver::Connect_(const IPAddress &ip_ad,
+                                              const Count &timeout) {
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::seconds(timeout);
+  sockpp::inet_address addr(ip_ad.host, ip_ad.port);
+  sockpp::tcp_connector conn;
+  TTime wait = kMinRetryWait;
+  while (!conn.connect(addr)) {
+    if (timeout > 0 && std::chrono::steady_clock::now() >= deadline) {
+      std::cerr << "Connect to " << ip_ad.host << ":" << ip_ad.port
+                << " timed out: " << conn.last_error_str() << std::endl;
+      exit(-1);
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(wait));
+    wait = wait * 2 < kMaxRetryWait ? wait * 2 : kMaxRetryWait;
+  }
+  return sockpp::tcp_socket(conn.release());
 }
 
-//Receive messages from another host
-void ConnectionSolver::Receive(const DataSize &size, void *buf) {
-  conn_.read_n(buf, size);
-}
+//Static values
+const TTime ConnectionSolver::kMinRetryWait = 100;
+const TTime ConnectionSolver::kMaxRetryWait = 100000;
 
 } // namespace exr
@@ -3,29 +3,31 @@
 
 #include "sockpp/tcp_connector.h"
 
-#include "data/access/transmit_interface.hh"
+#include "data/access/socket_solver.hh"
 #include "util/typedef.hh"
 
 namespace exr {
 
 /* Connected to a listening port and send/receive data */
-class ConnectionSolver : public TransmitInterface
+class ConnectionSolver : public SocketSolver
 {
  public:
-  ConnectionSolver(const exr::IPAddress &ip_ad);
+  ConnectionSolver(const exr::IPAddress &ip_ad,
+                   const AccessOptions &options = AccessOptions());
   ~ConnectionSolver();
 
-  //Implement TransmitInterface: to receive/send messages
-  void Send(const exr::DataSize &size, void *buf) override;
-  void Receive(const exr::DataSize &size, void *buf) override;
-
   //ConnectionSolver is neither copyable nor movable
   ConnectionSolver(const ConnectionSolver&) = delete;
   ConnectionSolver& operator=(const ConnectionSolver&) = delete;
 
  private:
-  //The saved connection
-  sockpp::tcp_connector conn_;
+  //Connect to the server and get the connected socket, retrying with
+  //    growing intervals until the timeout (in seconds, 0 for no limit)
+  static sockpp::tcp_socket Connect_(const exr::IPAddress &ip_ad,
+                                     const Count &timeout);
+
+  static const TTime kMinRetryWait; //In microseconds
+  static const TTime kMaxRetryWait;
 };
 
 } // namespace exr
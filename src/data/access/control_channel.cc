@@ -0,0 +1,203 @@
+#include "data/access/control_channel.hh"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "util/cpu_topology.hh"
+
+namespace exr {
+
+//Constructor and destructor
+ControlChannel::ControlChannel(std::unique_ptr<SocketSolver> ss)
+    : ss_(std::move(ss)), closed_(false), on_run_(false) {
+  for (auto &slow : slow_) slow = false;
+}
+
+ControlChannel::~ControlChannel() { Close(); }
+
+void ControlChannel::Run() {
+  on_run_ = true;
+  reader_ = std::thread([&] {
+    CpuTopology::Place({"ctrl"}, 0);
+    Read_();
+  });
+  worker_ = std::thread([&] {
+    CpuTopology::Place({"ctrl"}, 1);
+    Work_();
+  });
+}
+
+//Shutting down the socket makes the reader return
+void ControlChannel::Close() {
+  if (!on_run_) return;
+  on_run_ = false;
+  shutdown(ss_->get_handle(), SHUT_RDWR);
+  reader_.join();
+  std::unique_lock<std::mutex> lck(work_mtx_);
+  work_cv_.notify_all();
+  lck.unlock();
+  worker_.join();
+}
+
+void ControlChannel::Post(const ControlType &type, const void *buf,
+                          const DataSize &size) {
+  Header header{type, static_cast<uint32_t>(size)};
+  struct iovec iov[2] = {{&header, sizeof(header)},
+                         {const_cast<void*>(buf), static_cast<size_t>(size)}};
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = size > 0 ? 2 : 1;
+
+  std::unique_lock<std::mutex> lck(send_mtx_);
+  while (msg.msg_iovlen > 0) {
+    auto s = sendmsg(ss_->get_handle(), &msg, MSG_NOSIGNAL);
+    if (s < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EPIPE || errno == ECONNRESET) return;
+      std::cerr << "Send control error: " << strerror(errno) << std::endl;
+      exit(-1);
+    }
+    SocketSolver::SkipSent(msg, s);
+  }
+}
+
+void ControlChannel::On(const ControlType &type, Handler handler,
+                        const bool &slow) {
+  auto t = static_cast<size_t>(type);
+  std::unique_lock<std::mutex> dlck(dispatch_mtx_);
+  std::unique_lock<std::mutex> lck(box_mtx_);
+  auto waiting = std::move(boxes_[t]);
+  boxes_[t].clear();
+  lck.unlock();
+  handlers_[t] = std::move(handler);
+  slow_[t] = slow;
+  for (auto &msg : waiting) {
+    if (slow)
+      PushWork_(type, std::move(msg));
+    else
+      handlers_[t](msg);
+  }
+}
+
+bool ControlChannel::Take(const ControlType &type, Message &msg) {
+  auto &box = boxes_[static_cast<size_t>(type)];
+  std::unique_lock<std::mutex> lck(box_mtx_);
+  box_cv_.wait(lck, [&] { return !box.empty() || closed_; });
+  if (box.empty()) return false;
+  msg = std::move(box.front());
+  box.pop_front();
+  return true;
+}
+
+//Heartbeats are taken one at a time
+TTime ControlChannel::Ping() {
+  std::unique_lock<std::mutex> lck(ping_mtx_);
+  auto now = [] {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  };
+  Beat beat{now(), false};
+  Post(ControlType::kHeartbeat, &beat, sizeof(beat));
+  Message msg;
+  if (!Take(ControlType::kHeartbeat, msg)) return -1;
+  return now() - reinterpret_cast<Beat*>(msg.data())->time;
+}
+
+//Read the messages until the connection is closed
+void ControlChannel::Read_() {
+  while (true) {
+    Header header;
+    if (!ReadN_(&header, sizeof(header))) break;
+    //The header is checked before allocating for the content
+    if (header.type >= ControlType::kTypeNum) {
+      std::cerr << "Unknown control message "
+                << static_cast<int>(header.type) << std::endl;
+      exit(-1);
+    }
+    if (header.size > kMaxMessageSize) {
+      std::cerr << "Control message of " << header.size
+                << " bytes is larger than " << kMaxMessageSize << std::endl;
+      exit(-1);
+    }
+    Message msg(header.size);
+    if (header.size > 0 && !ReadN_(msg.data(), header.size)) break;
+    Dispatch_(header.type, std::move(msg));
+  }
+  std::unique_lock<std::mutex> lck(box_mtx_);
+  closed_ = true;
+  box_cv_.notify_all();
+}
+
+bool ControlChannel::ReadN_(void *buf, const size_t &size) {
+  size_t got = 0;
+  while (got < size) {
+    auto r = recv(ss_->get_handle(), static_cast<BufUnit*>(buf) + got,
+                  size - got, 0);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) return false;
+    got += r;
+  }
+  return true;
+}
+
+//The heartbeats from the other side are echoed at once
+void ControlChannel::Dispatch_(const ControlType &type, Message msg) {
+  if (type == ControlType::kHeartbeat && msg.size() == sizeof(Beat)) {
+    auto beat = reinterpret_cast<Beat*>(msg.data());
+    if (!beat->echo) {
+      beat->echo = true;
+      Post(type, beat, sizeof(*beat));
+      return;
+    }
+  }
+
+  auto t = static_cast<size_t>(type);
+  std::unique_lock<std::mutex> dlck(dispatch_mtx_);
+  if (handlers_[t] && slow_[t]) {
+    PushWork_(type, std::move(msg));
+    return;
+  }
+  if (handlers_[t]) {
+    handlers_[t](msg);
+    return;
+  }
+  std::unique_lock<std::mutex> lck(box_mtx_);
+  boxes_[t].push_back(std::move(msg));
+  box_cv_.notify_all();
+}
+
+//The handler is taken out of the lock, so that the reader keeps on
+//    dispatching while it runs
+void ControlChannel::Work_() {
+  while (true) {
+    std::unique_lock<std::mutex> lck(work_mtx_);
+    work_cv_.wait(lck, [&] { return !works_.empty() || !on_run_; });
+    if (!on_run_) break;
+    auto work = std::move(works_.front());
+    works_.pop_front();
+    lck.unlock();
+
+    std::unique_lock<std::mutex> dlck(dispatch_mtx_);
+    auto handler = handlers_[static_cast<size_t>(work.first)];
+    dlck.unlock();
+    handler(work.second);
+  }
+}
+
+void ControlChannel::PushWork_(const ControlType &type, Message msg) {
+  std::unique_lock<std::mutex> lck(work_mtx_);
+  works_.emplace_back(type, std::move(msg));
+  work_cv_.notify_one();
+}
+
+//Static values
+const uint32_t ControlChannel::kMaxMessageSize = 1 << 20;
+
+} // namespace exr
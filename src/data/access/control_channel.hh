@@ -0,0 +1,116 @@
+#ifndef EXR_DATA_ACCESS_CONTROLCHANNEL_HH_
+#define EXR_DATA_ACCESS_CONTROLCHANNEL_HH_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "data/access/socket_solver.hh"
+#include "util/typedef.hh"
+
+namespace exr {
+
+//Types of the control messages
+enum class ControlType : uint8_t {
+  kTask,      //Master to node: a RepairTask followed by the source ids
+  kBandwidth, //Master to node: load the next bandwidths and set them
+  kReload,    //Master to node: reopen the bandwidth file
+  kShutdown,  //Master to node: all the tasks are finished
+  kHeartbeat, //Either side: echoed by the channel itself
+  kStats,     //Master to node: request, node to master: Traffic
+  kAck,       //Node to master: a bandwidth message is done
+  kDone,      //Node to master: the task id stored
+  kCredit,    //Between nodes: credits of the flow control
+  kTypeNum
+};
+
+/* Typed messages on a connection of their own, so that they are not
+ * queued behind the pieces. A reader thread dispatches each message to the
+ * handler of its type, messages without a handler wait to be taken. Slow
+ * handlers run on a worker thread, so that the heartbeats and the credits
+ * are not held behind them */
+class ControlChannel
+{
+ public:
+  using Message = std::vector<BufUnit>;
+  //Called on the reader thread, or on the worker if slow, should not
+  //    wait for other messages
+  using Handler = std::function<void(const Message &msg)>;
+
+  explicit ControlChannel(std::unique_ptr<SocketSolver> ss);
+  ~ControlChannel();
+
+  //Start reading, handlers can be set before or after
+  void Run();
+  //Stop reading, the messages waiting are dropped
+  void Close();
+
+  //Send a message, the messages to a closed node are dropped
+  void Post(const ControlType &type, const void *buf = nullptr,
+            const DataSize &size = 0);
+  //Handle the messages of a type, including those have arrived,
+  //    a slow handler (e.g. running a command) runs on the worker
+  void On(const ControlType &type, Handler handler,
+          const bool &slow = false);
+  //Wait for a message of a type without handler, false if closed
+  bool Take(const ControlType &type, Message &msg);
+  //Round trip time of a heartbeat in microseconds
+  TTime Ping();
+
+  //ControlChannel is neither copyable nor movable
+  ControlChannel(const ControlChannel&) = delete;
+  ControlChannel& operator=(const ControlChannel&) = delete;
+
+ private:
+  struct Header {
+    ControlType type;
+    uint32_t size;
+  };
+  struct Beat {
+    TTime time;
+    bool echo;
+  };
+
+  std::unique_ptr<SocketSolver> ss_;
+  std::mutex send_mtx_;
+  std::mutex ping_mtx_;
+
+  //Handlers are called in the order of the messages, the slow ones in
+  //    the order among themselves
+  std::mutex dispatch_mtx_;
+  Handler handlers_[static_cast<size_t>(ControlType::kTypeNum)];
+  bool slow_[static_cast<size_t>(ControlType::kTypeNum)];
+
+  std::mutex work_mtx_;
+  std::condition_variable work_cv_;
+  std::deque<std::pair<ControlType, Message>> works_;
+  std::thread worker_;
+
+  std::mutex box_mtx_;
+  std::condition_variable box_cv_;
+  std::deque<Message> boxes_[static_cast<size_t>(ControlType::kTypeNum)];
+  bool closed_;
+
+  std::atomic<bool> on_run_;
+  std::thread reader_;
+
+  void Read_();
+  bool ReadN_(void *buf, const size_t &size);
+  void Dispatch_(const ControlType &type, Message msg);
+  //Run the slow handlers until closed
+  void Work_();
+  void PushWork_(const ControlType &type, Message msg);
+
+  static const uint32_t kMaxMessageSize;
+};
+
+} // namespace exr
+
+#endif // EXR_DATA_ACCESS_CONTROLCHANNEL_HH_
@@ -0,0 +1,69 @@
+#include "data/access/credit_gate.hh"
+
+#include <algorithm>
+#include <utility>
+
+namespace exr {
+
+//Constructor and destructor
+CreditGate::CreditGate(const Count &total, const Count &window, Grant grant)
+    : total_(total), window_(window),
+      batch_(std::max<Count>(window / 4, 1)), grant_(std::move(grant)),
+      links_(std::make_unique<Link[]>(total)), stall_num_(0) {
+  for (Count i = 0; i < total; ++i) {
+    links_[i].open = false;
+    links_[i].credits = links_[i].consumed = 0;
+  }
+}
+
+CreditGate::~CreditGate() { Close(); }
+
+void CreditGate::Open(const Count &peer_id) {
+  std::unique_lock<std::mutex> lck(links_[peer_id].mtx);
+  links_[peer_id].open = true;
+  lck.unlock();
+  grant_(peer_id, window_);
+}
+
+void CreditGate::Close() {
+  for (Count i = 0; i < total_; ++i) {
+    std::unique_lock<std::mutex> lck(links_[i].mtx);
+    links_[i].open = false;
+    links_[i].cv.notify_all();
+  }
+}
+
+//Links not opened, e.g. with the master, are not limited
+void CreditGate::Acquire(const Count &tar_id, const Count &n) {
+  auto &link = links_[tar_id];
+  std::unique_lock<std::mutex> lck(link.mtx);
+  if (!link.open) return;
+  if (link.credits < n) {
+    ++stall_num_;
+    link.cv.wait(lck, [&] { return link.credits >= n || !link.open; });
+    if (link.credits < n) return;
+  }
+  link.credits -= n;
+}
+
+void CreditGate::Release(const Count &src_id) {
+  auto &link = links_[src_id];
+  std::unique_lock<std::mutex> lck(link.mtx);
+  if (!link.open || ++link.consumed < batch_) return;
+  auto credits = link.consumed;
+  link.consumed = 0;
+  lck.unlock();
+  grant_(src_id, credits);
+}
+
+void CreditGate::Add(const Count &peer_id, const Count &credits) {
+  auto &link = links_[peer_id];
+  std::unique_lock<std::mutex> lck(link.mtx);
+  link.credits += credits;
+  link.cv.notify_all();
+}
+
+uint64_t CreditGate::get_stall_num() { return stall_num_; }
+Count CreditGate::get_max_acquire() { return window_ - batch_ + 1; }
+
+} // namespace exr
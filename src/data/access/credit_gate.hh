@@ -0,0 +1,72 @@
+#ifndef EXR_DATA_ACCESS_CREDITGATE_HH_
+#define EXR_DATA_ACCESS_CREDITGATE_HH_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "util/typedef.hh"
+
+namespace exr {
+
+/* Credit-based flow control of the pieces between nodes: a sender spends
+ * a credit for each piece written to a node, and the receiver grants the
+ * credit back after the piece is consumed, so at most window pieces are in
+ * flight on each link */
+class CreditGate
+{
+ public:
+  //Send credits to a node
+  using Grant = std::function<void(const Count &peer_id,
+                                   const Count &credits)>;
+
+  CreditGate(const Count &total, const Count &window, Grant grant);
+  ~CreditGate();
+
+  //Limit the link with a node and grant the window to it
+  void Open(const Count &peer_id);
+  //Wake up the senders waiting, the links are not limited any more
+  void Close();
+
+  //Wait for n credits to send n pieces to the node, taken all at once so
+  //    that the senders of a link never hold a part of the window each,
+  //    n should be no more than get_max_acquire()
+  void Acquire(const Count &tar_id, const Count &n = 1);
+  //A piece from the node has been consumed, its credit goes back in batches
+  void Release(const Count &src_id);
+  //Credits granted by the node
+  void Add(const Count &peer_id, const Count &credits);
+
+  //Number of times a sender has waited for credits
+  uint64_t get_stall_num();
+  //Most credits can be waited for at once, as less than a batch of the
+  //    window may be consumed but not granted back
+  Count get_max_acquire();
+
+  //CreditGate is neither copyable nor movable
+  CreditGate(const CreditGate&) = delete;
+  CreditGate& operator=(const CreditGate&) = delete;
+
+ private:
+  struct Link {
+    bool open;
+    Count credits;  //Pieces can be sent
+    Count consumed; //Pieces consumed but not granted
+    std::mutex mtx;
+    std::condition_variable cv;
+  };
+
+  Count total_;
+  Count window_;
+  Count batch_; //Grant after this number of pieces are consumed
+  Grant grant_;
+  std::unique_ptr<Link[]> links_;
+  std::atomic<uint64_t> stall_num_;
+};
+
+} // namespace exr
+
+#endif // EXR_DATA_ACCESS_CREDITGATE_HH_
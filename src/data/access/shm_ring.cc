@@ -0,0 +1,136 @@
+#include "data/access/shm_ring.hh"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <thread>
+
+namespace exr {
+
+//Constructor
+ShmRing::ShmRing(void *area, const DataSize &capacity)
+    : ctl_(static_cast<Control*>(area)),
+      data_(static_cast<BufUnit*>(area) + sizeof(Control)),
+      capacity_(capacity) {}
+
+void ShmRing::Init() {
+  ctl_->head = 0;
+  ctl_->tail = 0;
+  ctl_->data_seq = 0;
+  ctl_->space_seq = 0;
+  ctl_->reader_waiting = 0;
+  ctl_->writer_waiting = 0;
+  ctl_->closed = 0;
+}
+
+//Copy as much as the free space allows, then wait for the consumer
+bool ShmRing::Write(const void *buf, const DataSize &size) {
+  auto src = static_cast<const BufUnit*>(buf);
+  DataSize done = 0;
+  uint64_t head = ctl_->head.load(std::memory_order_relaxed);
+  Count spin = 0;
+  while (done < size) {
+    if (ctl_->closed) return false;
+    auto seq = ctl_->space_seq.load();
+    DataSize space = capacity_ - (head - ctl_->tail.load());
+    if (space == 0) {
+      if (++spin < kSpinNum)
+        std::this_thread::yield();
+      else
+        Wait_(false, seq);
+      continue;
+    }
+    spin = 0;
+
+    //The free space may be split by the end of the ring
+    DataSize n = size - done < space ? size - done : space;
+    DataSize pos = head % capacity_;
+    DataSize first = n < capacity_ - pos ? n : capacity_ - pos;
+    memcpy(data_ + pos, src + done, first);
+    memcpy(data_, src + done + first, n - first);
+
+    head += n;
+    done += n;
+    ctl_->head.store(head);
+    Wake_(ctl_->data_seq, ctl_->reader_waiting);
+  }
+  return true;
+}
+
+//Copy what has arrived, then wait for the producer
+bool ShmRing::Read(void *buf, const DataSize &size) {
+  auto tar = static_cast<BufUnit*>(buf);
+  DataSize done = 0;
+  uint64_t tail = ctl_->tail.load(std::memory_order_relaxed);
+  Count spin = 0;
+  while (done < size) {
+    auto seq = ctl_->data_seq.load();
+    DataSize avail = ctl_->head.load() - tail;
+    if (avail == 0) {
+      if (ctl_->closed) return false;
+      if (++spin < kSpinNum)
+        std::this_thread::yield();
+      else
+        Wait_(true, seq);
+      continue;
+    }
+    spin = 0;
+
+    DataSize n = size - done < avail ? size - done : avail;
+    DataSize pos = tail % capacity_;
+    DataSize first = n < capacity_ - pos ? n : capacity_ - pos;
+    memcpy(tar + done, data_ + pos, first);
+    memcpy(tar + done + first, data_, n - first);
+
+    tail += n;
+    done += n;
+    ctl_->tail.store(tail);
+    Wake_(ctl_->space_seq, ctl_->writer_waiting);
+  }
+  return true;
+}
+
+void ShmRing::Close() {
+  ctl_->closed = 1;
+  ++ctl_->data_seq;
+  ++ctl_->space_seq;
+  syscall(SYS_futex, &ctl_->data_seq, FUTEX_WAKE, INT32_MAX,
+          nullptr, nullptr, 0);
+  syscall(SYS_futex, &ctl_->space_seq, FUTEX_WAKE, INT32_MAX,
+          nullptr, nullptr, 0);
+}
+
+DataSize ShmRing::AreaSize(const DataSize &capacity) {
+  return sizeof(Control) + capacity;
+}
+
+//The flag is set before checking the ring again, so that a wake-up after
+//    the check always changes the sequence number and the wait returns
+void ShmRing::Wait_(const bool &for_data, const uint32_t &old) {
+  auto &seq = for_data ? ctl_->data_seq : ctl_->space_seq;
+  auto &waiting = for_data ? ctl_->reader_waiting : ctl_->writer_waiting;
+  waiting = 1;
+  DataSize used = ctl_->head.load() - ctl_->tail.load();
+  if (!ctl_->closed && used == (for_data ? 0 : capacity_)) {
+    struct timespec ts{0, kWaitNs};
+    syscall(SYS_futex, &seq, FUTEX_WAIT, old, &ts, nullptr, 0);
+  }
+  waiting = 0;
+}
+
+void ShmRing::Wake_(std::atomic<uint32_t> &seq,
+                    std::atomic<uint32_t> &waiting) {
+  if (waiting.load()) {
+    ++seq;
+    syscall(SYS_futex, &seq, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+  }
+}
+
+//Static values
+const Count ShmRing::kSpinNum = 64;
+const long ShmRing::kWaitNs = 100000000;
+
+} // namespace exr
@@ -0,0 +1,63 @@
+#ifndef EXR_DATA_ACCESS_SHMRING_HH_
+#define EXR_DATA_ACCESS_SHMRING_HH_
+
+#include <atomic>
+#include <cstdint>
+
+#include "util/typedef.hh"
+
+namespace exr {
+
+/* A single-producer single-consumer byte ring placed in memory shared by two
+ * processes, the waiting side sleeps on a futex of the shared control block */
+class ShmRing
+{
+ public:
+  //The control block, placed before the data of the ring
+  struct Control {
+    alignas(64) std::atomic<uint64_t> head; //Written by the producer
+    alignas(64) std::atomic<uint64_t> tail; //Written by the consumer
+    alignas(64) std::atomic<uint32_t> data_seq;  //Futex: new data
+    std::atomic<uint32_t> space_seq;             //Futex: new space
+    std::atomic<uint32_t> reader_waiting;
+    std::atomic<uint32_t> writer_waiting;
+    std::atomic<uint32_t> closed;
+  };
+
+  ShmRing(void *area, const DataSize &capacity);
+  ~ShmRing() = default;
+
+  //Initialize the control block, called once by the creator of the memory
+  void Init();
+
+  //Copy data into/out of the ring, blocking until all the bytes are done,
+  //    return false if the ring is closed before that
+  bool Write(const void *buf, const DataSize &size);
+  bool Read(void *buf, const DataSize &size);
+  //Wake up and stop the other side
+  void Close();
+
+  //Size of the shared memory needed by a ring
+  static DataSize AreaSize(const DataSize &capacity);
+
+  //ShmRing is neither copyable nor movable
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+ private:
+  Control *ctl_;
+  BufUnit *data_;
+  DataSize capacity_;
+
+  //Sleep until the sequence number changes or timeout,
+  //    for_data: the reader waits for data, or the writer waits for space
+  void Wait_(const bool &for_data, const uint32_t &old);
+  void Wake_(std::atomic<uint32_t> &seq, std::atomic<uint32_t> &waiting);
+
+  static const Count kSpinNum;
+  static const long kWaitNs;
+};
+
+} // namespace exr
+
+#endif // EXR_DATA_ACCESS_SHMRING_HH_
@@ -0,0 +1,124 @@
+#include "data/access/shm_solver.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace exr {
+
+//Create the memory and send its place to the peer
+std::unique_ptr<ShmSolver> ShmSolver::Offer(
+    std::unique_ptr<SocketSolver> &ss, const bool &enable) {
+  ShmOffer offer{0, -1, 0};
+  void *area = MAP_FAILED;
+  if (enable) {
+    offer.fd = memfd_create("exr-shm", MFD_CLOEXEC);
+    if (offer.fd >= 0 && ftruncate(offer.fd, AreaSize_()) == 0)
+      area = mmap(nullptr, AreaSize_(), PROT_READ | PROT_WRITE,
+                  MAP_SHARED, offer.fd, 0);
+    if (area != MAP_FAILED) {
+      std::random_device rd;
+      offer.pid = getpid();
+      offer.token = (static_cast<uint64_t>(rd()) << 32) | rd();
+      memcpy(area, &offer.token, sizeof(offer.token));
+      auto base = static_cast<BufUnit*>(area) + kPageSize;
+      ShmRing(base, kRingCapacity).Init();
+      ShmRing(base + RingSpan_(), kRingCapacity).Init();
+    }
+  }
+
+  //The peer opens the memfd by /proc before it is closed here
+  ss->Send(sizeof(offer), &offer);
+  uint8_t ok = 0;
+  if (offer.pid != 0) ss->Receive(sizeof(ok), &ok);
+  if (offer.fd >= 0) close(offer.fd);
+  if (!ok) {
+    if (area != MAP_FAILED) munmap(area, AreaSize_());
+    return nullptr;
+  }
+  return std::unique_ptr<ShmSolver>(
+      new ShmSolver(std::move(ss), static_cast<BufUnit*>(area), true));
+}
+
+//Map the memory of the peer if it's on this host
+std::unique_ptr<ShmSolver> ShmSolver::Answer(
+    std::unique_ptr<SocketSolver> &ss, const bool &enable) {
+  ShmOffer offer;
+  ss->Receive(sizeof(offer), &offer);
+  if (offer.pid == 0) return nullptr;
+
+  void *area = MAP_FAILED;
+  auto path = "/proc/" + std::to_string(offer.pid) +
+              "/fd/" + std::to_string(offer.fd);
+  int fd = enable ? open(path.c_str(), O_RDWR | O_CLOEXEC) : -1;
+  struct stat st;
+  if (fd >= 0 && fstat(fd, &st) == 0 &&
+      static_cast<DataSize>(st.st_size) == AreaSize_())
+    area = mmap(nullptr, AreaSize_(), PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd, 0);
+  if (fd >= 0) close(fd);
+  //The same pid and fd on another host is a different file
+  if (area != MAP_FAILED &&
+      memcmp(area, &offer.token, sizeof(offer.token)) != 0) {
+    munmap(area, AreaSize_());
+    area = MAP_FAILED;
+  }
+
+  uint8_t ok = area != MAP_FAILED;
+  ss->Send(sizeof(ok), &ok);
+  if (!ok) return nullptr;
+  return std::unique_ptr<ShmSolver>(
+      new ShmSolver(std::move(ss), static_cast<BufUnit*>(area), false));
+}
+
+//Constructor and destructor
+ShmSolver::ShmSolver(std::unique_ptr<SocketSolver> ss, BufUnit *area,
+                     const bool &offered)
+    : ss_(std::move(ss)), area_(area),
+      out_(area + kPageSize + (offered ? 0 : RingSpan_()), kRingCapacity),
+      in_(area + kPageSize + (offered ? RingSpan_() : 0), kRingCapacity) {}
+
+ShmSolver::~ShmSolver() {
+  out_.Close();
+  munmap(area_, AreaSize_());
+}
+
+//Send messages to another process
+void ShmSolver::Send(const DataSize &size, void *buf) {
+  out_.Write(buf, size);
+}
+
+void ShmSolver::SendV(struct iovec *iov, const Count &n) {
+  for (Count i = 0; i < n; ++i)
+    if (!out_.Write(iov[i].iov_base, iov[i].iov_len)) return;
+}
+
+//Receive messages from another process
+void ShmSolver::Receive(const DataSize &size, void *buf) {
+  in_.Read(buf, size);
+}
+
+//Data is copied into the ring when sent
+void ShmSolver::Flush() {}
+
+//Rings can't be polled
+int ShmSolver::get_handle() { return -1; }
+
+DataSize ShmSolver::RingSpan_() {
+  auto size = ShmRing::AreaSize(kRingCapacity);
+  return (size + kPageSize - 1) / kPageSize * kPageSize;
+}
+
+DataSize ShmSolver::AreaSize_() { return kPageSize + RingSpan_() * 2; }
+
+//Static values
+const DataSize ShmSolver::kPageSize = 4096;
+const DataSize ShmSolver::kRingCapacity = 4 << 20;
+
+} // namespace exr
@@ -0,0 +1,63 @@
+#ifndef EXR_DATA_ACCESS_SHMSOLVER_HH_
+#define EXR_DATA_ACCESS_SHMSOLVER_HH_
+
+#include <memory>
+
+#include "data/access/shm_ring.hh"
+#include "data/access/socket_solver.hh"
+#include "data/access/transmit_interface.hh"
+#include "util/typedef.hh"
+
+namespace exr {
+
+/* Send/receive data through two rings in shared memory when the peer runs on
+ * the same host, the socket is only used for the handshake */
+class ShmSolver : public TransmitInterface
+{
+ public:
+  //Ask the peer to share a memfd created here, or answer such a request,
+  //    the socket is taken only if succeeded, otherwise nullptr is returned
+  static std::unique_ptr<ShmSolver> Offer(std::unique_ptr<SocketSolver> &ss,
+                                          const bool &enable);
+  static std::unique_ptr<ShmSolver> Answer(std::unique_ptr<SocketSolver> &ss,
+                                           const bool &enable);
+  ~ShmSolver();
+
+  //Implement TransmitInterface: to receive/send messages
+  void Send(const DataSize &size, void *buf) override;
+  void SendV(struct iovec *iov, const Count &n) override;
+  void Receive(const DataSize &size, void *buf) override;
+  void Flush() override;
+  int get_handle() override;
+
+  //ShmSolver is neither copyable nor movable
+  ShmSolver(const ShmSolver&) = delete;
+  ShmSolver& operator=(const ShmSolver&) = delete;
+
+ private:
+  //Handshake message, pid is 0 if not offering
+  struct ShmOffer {
+    int32_t pid;
+    int32_t fd;
+    uint64_t token; //Also written in the memory to identify it
+  };
+
+  ShmSolver(std::unique_ptr<SocketSolver> ss, BufUnit *area,
+            const bool &offered);
+
+  std::unique_ptr<SocketSolver> ss_; //Owner of the connection
+  BufUnit *area_;
+  ShmRing out_; //Data to the peer
+  ShmRing in_;  //Data from the peer
+
+  //Layout of the memory: a page with the token, then the two rings
+  static DataSize RingSpan_();
+  static DataSize AreaSize_();
+
+  static const DataSize kPageSize;
+  static const DataSize kRingCapacity;
+};
+
+} // namespace exr
+
+#endif // EXR_DATA_ACCESS_SHMSOLVER_HH_
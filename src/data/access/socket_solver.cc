@@ -1,22 +1,225 @@
 #include "data/access/socket_solver.hh"
 
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
 #include <utility>
 
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
 namespace exr {
 
-SocketSolver::SocketSolver(sockpp::tcp_socket sock)
-    : sock_(std::move(sock)) {}
+SocketSolver::SocketSolver(sockpp::tcp_socket sock,
+                           const AccessOptions &options)
+    : sock_(std::move(sock)), profile_(options.socket),
+      zero_copy_(options.zero_copy),
+      zc_sent_(0), zc_done_(0), zc_copied_(0) {
+  Tune(sock_.handle(), profile_);
+
+  //Fall back to normal sending if zero-copy is not supported
+  int one = 1;
+  if (zero_copy_ && setsockopt(sock_.handle(), SOL_SOCKET, SO_ZEROCOPY,
+                               &one, sizeof(one)) < 0) {
+    std::cerr << "Zero-copy not supported: " << strerror(errno)
+              << std::endl;
+    zero_copy_ = false;
+  }
+}
 
-SocketSolver::~SocketSolver() = default;
+SocketSolver::~SocketSolver() { Flush(); }
 
 //Send messages to another host
 void SocketSolver::Send(const DataSize &size, void *buf) {
   sock_.write_n(buf, size);
 }
 
+//Send several buffers by as few system calls as possible. Only large
+//    buffers are worth pinning the pages, the small ones such as the
+//    piece headers are copied, as the callers reuse them at once
+void SocketSolver::SendV(struct iovec *iov, const Count &n) {
+  auto pinned = [&](const Count &i) {
+    return zero_copy_ &&
+           iov[i].iov_len >= static_cast<size_t>(kMinZeroCopySize);
+  };
+
+  //Only full segments leave until uncorked
+  int one = 1, zero = 0;
+  if (profile_.cork)
+    setsockopt(sock_.handle(), IPPROTO_TCP, TCP_CORK, &one, sizeof(one));
+
+  //The buffers are sent in runs of the same kind
+  bool reap = false;
+  for (Count i = 0, j; i < n; i = j) {
+    for (j = i + 1; j < n && pinned(j) == pinned(i); ++j) {}
+    int flags = MSG_NOSIGNAL | (j < n ? MSG_MORE : 0) |
+                (pinned(i) ? MSG_ZEROCOPY : 0);
+    reap |= SendMsg_(iov + i, j - i, flags);
+  }
+  if (profile_.cork)
+    setsockopt(sock_.handle(), IPPROTO_TCP, TCP_CORK, &zero, sizeof(zero));
+
+  //Keep the error queue short
+  if (reap) {
+    std::unique_lock<std::mutex> lck(zc_mtx_);
+    ReapCompletions_(false);
+  }
+}
+
 //Receive messages from another host
 void SocketSolver::Receive(const DataSize &size, void *buf) {
   sock_.read_n(buf, size);
+  //Quick ack mode is left by the kernel at times, so set it again
+  int one = 1;
+  if (profile_.quick_ack)
+    setsockopt(sock_.handle(), IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one));
+}
+
+//Wait for all the zero-copy sends before now to be completed
+void SocketSolver::Flush() {
+  if (!zero_copy_) return;
+  std::unique_lock<std::mutex> lck(zc_mtx_);
+  auto target = zc_sent_;
+  while (static_cast<int32_t>(target - zc_done_) > 0)
+    if (!ReapCompletions_(true)) return;
+}
+
+uint32_t SocketSolver::get_copied_num() {
+  std::unique_lock<std::mutex> lck(zc_mtx_);
+  return zc_copied_;
 }
 
+int SocketSolver::get_handle() { return sock_.handle(); }
+
+//Skip the buffers which have been sent out
+void SocketSolver::SkipSent(struct msghdr &msg, DataSize s) {
+  while (msg.msg_iovlen > 0 &&
+         static_cast<size_t>(s) >= msg.msg_iov->iov_len) {
+    s -= msg.msg_iov->iov_len;
+    ++msg.msg_iov;
+    --msg.msg_iovlen;
+  }
+  if (msg.msg_iovlen > 0) {
+    auto base = static_cast<BufUnit*>(msg.msg_iov->iov_base);
+    msg.msg_iov->iov_base = base + s;
+    msg.msg_iov->iov_len -= s;
+  }
+}
+
+//Options failed to set are reported but not fatal
+void SocketSolver::Tune(const int &fd, const SocketProfile &profile) {
+  int one = 1;
+  if (profile.no_delay &&
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) < 0)
+    std::cerr << "Set TCP_NODELAY error: " << strerror(errno) << std::endl;
+  if (profile.quick_ack &&
+      setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one)) < 0)
+    std::cerr << "Set TCP_QUICKACK error: " << strerror(errno) << std::endl;
+  if (profile.buf_size > 0) {
+    int size = profile.buf_size;
+    if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0)
+      std::cerr << "Set buffer size error: " << strerror(errno) << std::endl;
+  }
+  //Raising busy polling above the system setting needs CAP_NET_ADMIN
+  int usec = profile.busy_poll;
+  if (usec > 0 &&
+      setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) < 0)
+    std::cerr << "Set SO_BUSY_POLL error: " << strerror(errno) << std::endl;
+}
+
+//Send the buffers with the flags, returns whether any part is sent with
+//    MSG_ZEROCOPY, its notification is still to be reaped even if the rest
+//    is copied
+bool SocketSolver::SendMsg_(struct iovec *iov, const Count &n, int flags) {
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = n;
+  bool pinned = false;
+  while (msg.msg_iovlen > 0) {
+    auto s = sendmsg(sock_.handle(), &msg, flags);
+    if (s < 0) {
+      if (errno == EINTR) continue;
+      if (errno == ENOBUFS && (flags & MSG_ZEROCOPY)) {
+        //Out of pinned memory, copy the rest
+        flags &= ~MSG_ZEROCOPY;
+        continue;
+      }
+      std::cerr << "Send error: " << strerror(errno) << std::endl;
+      exit(-1);
+    }
+    if (flags & MSG_ZEROCOPY) {
+      std::unique_lock<std::mutex> lck(zc_mtx_);
+      ++zc_sent_;
+      pinned = true;
+    }
+    SkipSent(msg, s);
+  }
+  return pinned;
+}
+
+//Read the notifications of zero-copy sends, zc_mtx_ should be held.
+//    Returns false if no more can arrive, as the connection is broken
+bool SocketSolver::ReapCompletions_(const bool &wait) {
+  struct pollfd pfd{sock_.handle(), 0, 0};
+  if (wait && poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+    std::cerr << "Poll error: " << strerror(errno) << std::endl;
+    exit(-1);
+  }
+
+  char control[128];
+  struct msghdr msg;
+  Count reaped = 0;
+  while (true) {
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(sock_.handle(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+      std::cerr << "Zero-copy completion error: " << strerror(errno)
+                << std::endl;
+      return false;
+    }
+    ++reaped;
+
+    for (auto cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+      auto serr = reinterpret_cast<sock_extended_err*>(CMSG_DATA(cm));
+      if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+        continue;
+      //Notifications of sends [ee_info, ee_data] have arrived
+      auto num = serr->ee_data - serr->ee_info + 1;
+      zc_done_ += num;
+      if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) zc_copied_ += num;
+    }
+  }
+
+  //Woken up by a hang-up or an error of the socket but nothing to read,
+  //    the notifications left will never come
+  if (wait && reaped == 0 &&
+      (pfd.revents & (POLLHUP | POLLERR | POLLNVAL))) {
+    std::cerr << "Connection broken with " << zc_sent_ - zc_done_
+              << " zero-copy sends not completed" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//Static values
+const DataSize SocketSolver::kMinZeroCopySize = 16384;
+
 } // namespace exr
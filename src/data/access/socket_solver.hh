@@ -1,6 +1,9 @@
 #ifndef EXR_DATA_ACCESS_SOCKETSOLVER_HH_
 #define EXR_DATA_ACCESS_SOCKETSOLVER_HH_
 
+#include <cstdint>
+#include <mutex>
+
 #include "sockpp/tcp_acceptor.h"
 
 #include "data/access/transmit_interface.hh"
@@ -12,13 +15,26 @@ namespace exr {
 class SocketSolver : public TransmitInterface
 {
  public:
-  SocketSolver(sockpp::tcp_socket sock);
+  SocketSolver(sockpp::tcp_socket sock,
+               const AccessOptions &options = AccessOptions());
   ~SocketSolver();
 
   //Implement TransmitInterface: to receive/send messages
   void Send(const DataSize &size, void *buf) override;
+  void SendV(struct iovec *iov, const Count &n) override;
   void Receive(const DataSize &size, void *buf) override;
 
+  void Flush() override;
+  int get_handle() override;
+
+  //Number of zero-copy sends which the kernel copied anyway
+  uint32_t get_copied_num();
+
+  //Move msg forward by s bytes which have been sent out
+  static void SkipSent(struct msghdr &msg, DataSize s);
+  //Apply the options of a profile which are kept by the socket
+  static void Tune(const int &fd, const SocketProfile &profile);
+
   //SocketSolver is neither copyable nor movable
   SocketSolver(const SocketSolver&) = delete;
   SocketSolver& operator=(const SocketSolver&) = delete;
@@ -26,6 +42,20 @@ class SocketSolver : public TransmitInterface
  private:
   //The saved socket connection
   sockpp::tcp_socket sock_;
+  SocketProfile profile_;
+
+  //Zero-copy sending: buffers sent by MSG_ZEROCOPY are still used by the
+  //    kernel until their notifications arrive at the error queue
+  bool zero_copy_;
+  uint32_t zc_sent_;   //Number of zero-copy sends
+  uint32_t zc_done_;   //Number of completed zero-copy sends
+  uint32_t zc_copied_; //Number of sends the kernel fell back to copying
+  std::mutex zc_mtx_;
+
+  bool SendMsg_(struct iovec *iov, const Count &n, int flags);
+  bool ReapCompletions_(const bool &wait);
+
+  static const DataSize kMinZeroCopySize;
 };
 
 } // namespace exr
@@ -0,0 +1,96 @@
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "data/access/access_center.hh"
+#include "util/compressor.hh"
+#include "util/memory_pool.hh"
+#include "util/typedef.hh"
+#include "util/types.hh"
+
+//Main
+int main()
+{
+  //Parameters
+  const exr::Count total = 3, piece_num = 64;
+  const exr::DataSize psize = 1 << 15, size = psize * piece_num;
+  auto ip_ads = exr::IPAddressList(new exr::IPAddress[total]{
+      {"localhost", 10086},
+      {"localhost", 10087},
+      {"localhost", 10088}
+  });
+
+  //Use a codec of this build, links below 100 Mbps are compressed
+  exr::AccessOptions options;
+  options.shared_memory = false;
+  auto codecs = exr::Compressor::SupportedCodecs();
+  if (codecs & (1 << exr::Compressor::kLZ4))
+    options.codec = exr::Compressor::kLZ4;
+  else if (codecs & (1 << exr::Compressor::kZstd))
+    options.codec = exr::Compressor::kZstd;
+  options.compress_below = 100000;
+  std::cout << "Codec: " << options.codec << std::endl;
+
+  //Network connection
+  std::thread t[total];
+  std::array<exr::AccessCenter, total> ac = { {{0, total, options},
+                                               {1, total, options},
+                                               {2, total, options}} };
+  for (int i = 0; i < total; ++i)
+    t[i] = std::thread([&, i] { ac[i].Connect(ip_ads); });
+  for (int i = 0; i < total; ++i)
+    t[i].join();
+  std::cout << "Connected" << std::endl;
+  ac[1].SetLinkBandwidth(2, 50000);
+  ac[2].SetLinkBandwidth(1, 50000);
+
+  //Half of the pieces are text, the others are random
+  auto data = std::make_unique<exr::BufUnit[]>(size);
+  std::mt19937 gen(7);
+  for (exr::DataSize i = 0; i < size; ++i)
+    data[i] = (i / psize) % 2 ? static_cast<exr::BufUnit>(gen())
+                              : "abcdefghijklmnopqrstuvwxyz"[i % 26];
+
+  //Node 2 sends to node 1 piece by piece
+  exr::MemoryPool mp(total, size);
+  t[0] = std::thread([&] {
+    for (exr::Count i = 0; i < piece_num; ++i)
+      ac[2].SendPiece(1, {1, i * psize, psize}, data.get() + i * psize);
+  });
+  for (exr::Count i = 0; i < piece_num; ++i) {
+    exr::PieceHeader header;
+    ac[1].Receive(2, sizeof(header), &header);
+    ac[1].ReceiveContent(2, header, mp.Get(2, header.offset));
+  }
+  t[0].join();
+  std::cout << "Single path correct: "
+            << (memcmp(mp.Get(2, 0), data.get(), size) == 0) << std::endl;
+
+  //Node 1 sends to node 2 in batches
+  t[0] = std::thread([&] {
+    std::vector<exr::PieceHeader> headers;
+    std::vector<void*> bufs;
+    for (exr::Count i = 0; i < piece_num; ++i) {
+      headers.push_back({2, i * psize, psize});
+      bufs.push_back(data.get() + i * psize);
+    }
+    ac[1].SendPieces(2, headers.data(), bufs.data(), piece_num);
+  });
+  exr::MemoryPool mp2(total, size);
+  for (exr::Count i = 0; i < piece_num; ++i) {
+    exr::PieceHeader header;
+    ac[2].Receive(1, sizeof(header), &header);
+    ac[2].ReceiveContent(1, header, mp2.Get(1, header.offset));
+  }
+  t[0].join();
+  std::cout << "Batched path correct: "
+            << (memcmp(mp2.Get(1, 0), data.get(), size) == 0) << std::endl;
+
+  //The traffic on the wire is smaller than the pieces
+  std::cout << "Sent " << 2 * size << " bytes of pieces" << std::endl;
+  ac[1].ShowStats();
+  return 0;
+}
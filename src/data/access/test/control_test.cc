@@ -0,0 +1,93 @@
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "data/access/access_center.hh"
+#include "data/access/control_channel.hh"
+#include "util/typedef.hh"
+#include "util/types.hh"
+
+//Main
+int main()
+{
+  //Parameters
+  const exr::Count total = 3, ping_num = 100;
+  const exr::DataSize psize = 1 << 20;
+  auto ip_ads = exr::IPAddressList(new exr::IPAddress[total]{
+      {"localhost", 10086},
+      {"localhost", 10087},
+      {"localhost", 10088}
+  });
+  exr::AccessOptions options;
+  options.shared_memory = false;
+
+  //Network connection
+  std::thread t[total];
+  std::array<exr::AccessCenter, total> ac = { {{0, total, options},
+                                               {1, total, options},
+                                               {2, total, options}} };
+  for (int i = 0; i < total; ++i)
+    t[i] = std::thread([&, i] { ac[i].Connect(ip_ads); });
+  for (int i = 0; i < total; ++i)
+    t[i].join();
+  std::cout << "Connected" << std::endl;
+
+  //Typed messages, taken or handled
+  exr::Count task_id = 7;
+  ac[1].Control(2).Post(exr::ControlType::kDone, &task_id, sizeof(task_id));
+  exr::ControlChannel::Message msg;
+  ac[2].Control(1).Take(exr::ControlType::kDone, msg);
+  std::cout << "Done message: " << *reinterpret_cast<exr::Count*>(msg.data())
+            << std::endl;
+
+  //Round trips of the heartbeats, average in microseconds
+  auto ping = [&] {
+    exr::TTime sum = 0;
+    for (exr::Count i = 0; i < ping_num; ++i)
+      sum += ac[1].Control(2).Ping();
+    return sum / ping_num;
+  };
+  std::cout << "Idle round trip: " << ping() << " us" << std::endl;
+
+  //A slow handler runs on the worker and does not hold the heartbeats
+  std::atomic<bool> handled(false);
+  ac[2].Control(1).On(exr::ControlType::kReload,
+                      [&](const exr::ControlChannel::Message &msg) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    handled = true;
+  }, true);
+  ac[1].Control(2).Post(exr::ControlType::kReload);
+  std::cout << "Round trip beside a slow handler: " << ping() << " us, "
+            << "handled before: " << handled << std::endl;
+  while (!handled) std::this_thread::yield();
+
+  //The data connection between node 1 and 2 is saturated
+  std::atomic<bool> on_run(true);
+  auto buf = std::make_unique<exr::BufUnit[]>(psize);
+  t[0] = std::thread([&] {
+    exr::PieceHeader header{1, 0, psize};
+    while (on_run) {
+      ac[1].Send(2, sizeof(header), &header);
+      ac[1].Send(2, psize, buf.get());
+    }
+    header.size = 0;
+    ac[1].Send(2, sizeof(header), &header);
+  });
+  t[1] = std::thread([&] {
+    auto rbuf = std::make_unique<exr::BufUnit[]>(psize);
+    exr::PieceHeader header{0, 0, 0};
+    do {
+      ac[2].Receive(1, sizeof(header), &header);
+      ac[2].Receive(1, header.size, rbuf.get());
+    } while (header.size > 0);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::cout << "Loaded round trip: " << ping() << " us" << std::endl;
+  on_run = false;
+  t[0].join();
+  t[1].join();
+
+  return 0;
+}
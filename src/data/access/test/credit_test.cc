@@ -0,0 +1,114 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "data/access/access_center.hh"
+#include "util/memory_pool.hh"
+#include "util/typedef.hh"
+#include "util/types.hh"
+
+//Main
+int main()
+{
+  //Parameters
+  const exr::Count total = 3, piece_num = 64, window = 8;
+  const exr::DataSize psize = 1 << 12;
+  auto ip_ads = exr::IPAddressList(new exr::IPAddress[total]{
+      {"localhost", 10086},
+      {"localhost", 10087},
+      {"localhost", 10088}
+  });
+  exr::AccessOptions options;
+  options.shared_memory = false;
+  options.credit_slices = window;
+  options.stream_num = 2;
+
+  //Network connection
+  std::thread t[total];
+  std::array<exr::AccessCenter, total> ac = { {{0, total, options},
+                                               {1, total, options},
+                                               {2, total, options}} };
+  for (int i = 0; i < total; ++i)
+    t[i] = std::thread([&, i] { ac[i].Connect(ip_ads); });
+  for (int i = 0; i < total; ++i)
+    t[i].join();
+  std::cout << "Connected" << std::endl;
+
+  //Node 1 receives the pieces at once but consumes them slowly
+  exr::MemoryPool mp(total, psize * piece_num);
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::queue<exr::DataSize> placed;
+  t[1] = std::thread([&] {
+    for (exr::Count i = 0; i < piece_num; ++i) {
+      exr::PieceHeader header;
+      ac[1].Receive(2, sizeof(header), &header);
+      ac[1].ReceiveContent(2, header, mp.Get(2, header.offset));
+      std::unique_lock<std::mutex> lck(mtx);
+      placed.push(header.offset);
+      cv.notify_one();
+    }
+  });
+  std::atomic<exr::Count> consumed(0);
+  t[0] = std::thread([&] {
+    for (exr::Count i = 0; i < piece_num; ++i) {
+      std::unique_lock<std::mutex> lck(mtx);
+      cv.wait(lck, [&] { return !placed.empty(); });
+      placed.pop();
+      lck.unlock();
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      ++consumed;
+      ac[1].ReleaseCredit(2);
+    }
+  });
+
+  //Node 2 sends as fast as it can, but no more than the window is ahead
+  exr::BufUnit buf[psize] = "abcdefghijklmnopqrstuvwxyz";
+  exr::Count max_ahead = 0;
+  for (exr::Count i = 0; i < piece_num; ++i) {
+    ac[2].SendPiece(1, {1, i * psize, psize}, buf);
+    exr::Count ahead = i + 1 - consumed;
+    if (ahead > max_ahead) max_ahead = ahead;
+  }
+  t[0].join();
+  t[1].join();
+  std::cout << "Sent " << piece_num << " pieces with a window of "
+            << window << ", at most " << max_ahead << " were ahead"
+            << std::endl;
+
+  //Two senders on the same link, each sending more pieces at once than
+  //    the window, neither holds a part of the window waiting for the rest
+  const exr::Count batch = 2 * window;
+  for (exr::Count s = 0; s < 2; ++s) {
+    t[s] = std::thread([&, s] {
+      for (exr::Count i = 0; i < piece_num; ++i) {
+        exr::PieceHeader header;
+        ac[1].Receive(2, sizeof(header), &header, s);
+        ac[1].ReceiveContent(2, header, mp.Get(2, header.offset), s);
+        ac[1].ReleaseCredit(2);
+      }
+    });
+  }
+  std::thread senders[2];
+  for (exr::Count s = 0; s < 2; ++s) {
+    senders[s] = std::thread([&, s] {
+      std::vector<exr::PieceHeader> headers(batch, {1, 0, psize});
+      std::vector<void*> bufs(batch, buf);
+      for (exr::Count i = 0; i < piece_num; i += batch)
+        ac[2].SendPieces(1, headers.data(), bufs.data(), batch, s);
+    });
+  }
+  for (exr::Count s = 0; s < 2; ++s) {
+    senders[s].join();
+    t[s].join();
+  }
+  std::cout << "Two senders sent " << 2 * piece_num << " pieces in batches of "
+            << batch << std::endl;
+  return 0;
+}
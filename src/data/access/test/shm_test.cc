@@ -0,0 +1,71 @@
+#include <array>
+#include <iostream>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <thread>
+
+#include "data/access/access_center.hh"
+#include "util/memory_pool.hh"
+#include "util/typedef.hh"
+#include "util/types.hh"
+
+//Send pieces from node 1 to node 2, return the time used
+double Transmit(const exr::IPAddressList &ip_ads, const bool &shm,
+                const exr::DataSize &size, const exr::DataSize &psize) {
+  const exr::Count total = 3;
+  exr::AccessOptions options;
+  options.shared_memory = shm;
+
+  std::thread t[total];
+  std::array<exr::AccessCenter, total> ac = { {{0, total, options},
+                                               {1, total, options},
+                                               {2, total, options}} };
+  for (int i = 0; i < total; ++i)
+    t[i] = std::thread([&, i] { ac[i].Connect(ip_ads); });
+  for (int i = 0; i < total; ++i)
+    t[i].join();
+  exr::MemoryPool mp(total, size);
+
+  struct timeval start_time, end_time;
+  gettimeofday(&start_time, nullptr);
+  t[0] = std::thread([&] {
+    exr::BufUnit buf[psize] = "abcdefghijklmnopqrstuvwxyz";
+    for (exr::DataSize offset = 0; offset < size; offset += psize) {
+      exr::PieceHeader header{1, offset, psize};
+      struct iovec iov[2] = {{&header, sizeof(header)},
+                             {buf, static_cast<size_t>(psize)}};
+      ac[1].SendV(2, iov, 2);
+    }
+  });
+  exr::PieceHeader header{0, 0, 0};
+  for (exr::DataSize s = 0; s < size; s += header.size) {
+    ac[2].Receive(1, sizeof(header), &header);
+    ac[2].Receive(1, header.size, mp.Get(1, header.offset));
+  }
+  t[0].join();
+  gettimeofday(&end_time, nullptr);
+
+  std::cout << (shm ? "shared memory" : "loopback tcp") << ", last piece: ";
+  std::cout.write(mp.Get(1, size - psize), 26);
+  std::cout << std::endl;
+  return (end_time.tv_sec - start_time.tv_sec) * 1e6 +
+         (end_time.tv_usec - start_time.tv_usec);
+}
+
+int main()
+{
+  const exr::DataSize size = 1 << 28, psize = 1 << 15;
+  auto ip_ads = exr::IPAddressList(new exr::IPAddress[3]{
+      {"localhost", 10080},
+      {"localhost", 10081},
+      {"localhost", 10082}
+  });
+
+  for (bool shm : {false, true}) {
+    auto duration = Transmit(ip_ads, shm, size, psize);
+    std::cout << "  " << size << " bytes by psize " << psize
+              << ", using time: " << duration << " us ("
+              << size / duration << " MB/s)" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,105 @@
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sockpp/tcp_acceptor.h"
+
+#include "data/access/connection_solver.hh"
+#include "data/access/socket_solver.hh"
+#include "data/access/transmit_interface.hh"
+#include "util/typedef.hh"
+#include "util/types.hh"
+
+//Send slices one by one and wait for each to be acknowledged by the peer,
+//    the header and the content are sent by two writes or one SendV
+void PingPong(const exr::Port &port, const std::string &name,
+              const exr::SocketProfile &profile, const bool &vectored) {
+  const int times = 200;
+  const exr::DataSize psize = 1 << 15;
+  exr::AccessOptions options;
+  options.socket = profile;
+
+  //Connect
+  sockpp::tcp_acceptor acc(port);
+  if (!acc) {
+    std::cerr << acc.last_error_str() << std::endl;
+    exit(-1);
+  }
+  using pTI = std::unique_ptr<exr::TransmitInterface>;
+  pTI receiver;
+  std::thread acc_thread([&] {
+    receiver = pTI(new exr::SocketSolver(acc.accept(), options));
+  });
+  exr::ConnectionSolver sender({"localhost", port}, options);
+  acc_thread.join();
+
+  //The peer answers a byte for each slice
+  auto rbuf = std::make_unique<exr::BufUnit[]>(psize);
+  std::thread echo_thread([&] {
+    exr::PieceHeader header;
+    char ack = 1;
+    for (int i = 0; i < times; ++i) {
+      receiver->Receive(sizeof(header), &header);
+      receiver->Receive(header.size, rbuf.get());
+      receiver->Send(sizeof(ack), &ack);
+    }
+  });
+
+  auto sbuf = std::make_unique<exr::BufUnit[]>(psize);
+  std::vector<double> lat(times);
+  for (int i = 0; i < times; ++i) {
+    auto ts = std::chrono::steady_clock::now();
+    exr::PieceHeader header{1, i * psize, psize};
+    if (vectored) {
+      struct iovec iov[2] = {{&header, sizeof(header)},
+                             {sbuf.get(), static_cast<size_t>(psize)}};
+      sender.SendV(iov, 2);
+    } else {
+      sender.Send(sizeof(header), &header);
+      sender.Send(psize, sbuf.get());
+    }
+    char ack;
+    sender.Receive(sizeof(ack), &ack);
+    lat[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - ts).count() / 1e3;
+  }
+  echo_thread.join();
+
+  double sum = 0;
+  for (auto l : lat) sum += l;
+  std::sort(lat.begin(), lat.end());
+  std::cout << name << (vectored ? " (SendV)" : " (2 writes)") << ": avg "
+            << sum / times << " us, p50 " << lat[times / 2] << " us, p99 "
+            << lat[times * 99 / 100] << " us" << std::endl;
+}
+
+int main()
+{
+  //Profiles to compare
+  std::vector<std::pair<std::string, exr::SocketProfile>> profiles(6);
+  profiles[0].first = "kernel default";
+  profiles[0].second.no_delay = false;
+  profiles[1].first = "no delay";
+  profiles[2].first = "no delay + quick ack";
+  profiles[2].second.quick_ack = true;
+  profiles[3].first = "cork";
+  profiles[3].second.no_delay = false;
+  profiles[3].second.cork = true;
+  profiles[4].first = "no delay + 4 MiB buffers";
+  profiles[4].second.buf_size = 1 << 22;
+  profiles[5].first = "no delay + busy poll 50 us";
+  profiles[5].second.busy_poll = 50;
+
+  exr::Port port = 10090;
+  for (auto &p : profiles) {
+    PingPong(port++, p.first, p.second, false);
+    PingPong(port++, p.first, p.second, true);
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "sockpp/tcp_acceptor.h"
+
+#include "data/access/connection_solver.hh"
+#include "data/access/socket_solver.hh"
+#include "data/access/transmit_interface.hh"
+#include "util/typedef.hh"
+#include "util/types.hh"
+
+//CPU time (us) used by the calling thread
+double ThreadTime() {
+  struct rusage ru;
+  getrusage(RUSAGE_THREAD, &ru);
+  return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e6 +
+         ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+//Forward some slices through a connection and show the sender's CPU time
+void Forward(const exr::Port &port, const bool &zero_copy) {
+  const exr::DataSize total = 1 << 30, psize = 1 << 15,
+                      buf_size = 1 << 26;
+  exr::AccessOptions options;
+  options.zero_copy = zero_copy;
+
+  //Connect
+  sockpp::tcp_acceptor acc(port);
+  if (!acc) {
+    std::cerr << acc.last_error_str() << std::endl;
+    exit(-1);
+  }
+  using pTI = std::unique_ptr<exr::TransmitInterface>;
+  pTI receiver;
+  std::thread acc_thread([&] {
+    receiver = pTI(new exr::SocketSolver(acc.accept()));
+  });
+  exr::ConnectionSolver sender({"localhost", port}, options);
+  acc_thread.join();
+
+  //Receive in another thread
+  auto rbuf = std::make_unique<exr::BufUnit[]>(psize);
+  std::thread recv_thread([&] {
+    exr::PieceHeader header;
+    for (exr::DataSize s = 0; s < total; s += header.size) {
+      receiver->Receive(sizeof(header), &header);
+      receiver->Receive(header.size, rbuf.get());
+    }
+  });
+
+  //Send the slices like ProceedProcessor
+  auto sbuf = std::make_unique<exr::BufUnit[]>(buf_size);
+  struct timeval start_time, end_time;
+  gettimeofday(&start_time, nullptr);
+  double cpu_time = ThreadTime();
+  for (exr::DataSize s = 0; s < total; s += psize) {
+    exr::PieceHeader header{0, s % buf_size, psize};
+    struct iovec iov[2] = {{&header, sizeof(header)},
+                           {sbuf.get() + header.offset,
+                            static_cast<size_t>(psize)}};
+    sender.SendV(iov, 2);
+  }
+  sender.Flush();
+  cpu_time = ThreadTime() - cpu_time;
+  gettimeofday(&end_time, nullptr);
+  recv_thread.join();
+
+  double duration = (end_time.tv_sec - start_time.tv_sec) * 1e6 +
+                    (end_time.tv_usec - start_time.tv_usec);
+  std::cout << (zero_copy ? "zero-copy on:  " : "zero-copy off: ")
+            << "sender cpu " << cpu_time / (total >> 30)
+            << " us/GiB, wall " << duration / (total >> 30)
+            << " us/GiB, copied by kernel " << sender.get_copied_num()
+            << " times" << std::endl;
+  acc.close();
+}
+
+int main()
+{
+  Forward(10086, false);
+  Forward(10087, true);
+  return 0;
+}
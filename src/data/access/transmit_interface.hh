@@ -1,6 +1,8 @@
 #ifndef EXR_DATA_ACCESS_TRANSMITINTERFACE_HH_
 #define EXR_DATA_ACCESS_TRANSMITINTERFACE_HH_
 
+#include <sys/uio.h>
+
 #include "util/typedef.hh"
 
 namespace exr {
@@ -13,9 +15,20 @@ class TransmitInterface
   //Send data to another solver
   virtual void Send(const DataSize &size, void *buf) = 0;
 
+  //Send several buffers as one message (scatter/gather),
+  //    the content of iov may be changed after sending. Large buffers
+  //    may still be used until Flush, small ones can be reused at once
+  virtual void SendV(struct iovec *iov, const Count &n) = 0;
+
   //To receive data from others
   virtual void Receive(const DataSize &size, void *buf) = 0;
 
+  //Wait until the buffers of sent data are no longer used by the system
+  virtual void Flush() = 0;
+
+  //The file descriptor which can be polled, -1 if there isn't one
+  virtual int get_handle() = 0;
+
   //Virtual Destructor
   virtual ~TransmitInterface() {}
 };
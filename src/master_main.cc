@@ -43,7 +43,8 @@ int main(int argc, char *argv[])
 
   //Create the controller and connect to other nodes
   std::cout << "Creating and initializing the controller..." << std::endl;
-  Controller con(ar.get_total(), cr.get_size(), cr.get_psize());
+  Controller con(ar.get_total(), cr.get_size(), cr.get_psize(),
+                 cr.get_task_cap(), cr.get_lost_blocks());
   con.Connect(ar.GetAddresses());
   std::cout << "Connected" << std::endl << std::endl;
 
@@ -87,6 +88,7 @@ int main(int argc, char *argv[])
   std::cout << "All the tasks finished, sending closing signal to the nodes"
             << std::endl;
   result_file.close();
+  con.ShowNodeStats(ar.get_total());
   con.Close(ar.get_total());
   std::cout << "Closed." << std::endl;
   return 0;
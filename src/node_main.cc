@@ -4,6 +4,8 @@
 #include "config/bandwidth_solver.hh"
 #include "config/config_reader.hh"
 #include "repair/repairer.hh"
+#include "util/cpu_topology.hh"
+#include "util/rs_computer.hh"
 #include "util/typedef.hh"
 
 using exr::Count;
@@ -33,25 +35,39 @@ int main(int argc, char *argv[])
   AddressReader ar;
   ar.Load(cr.get_addr_conf_path());
 
+  //Where the threads run
+  exr::CpuTopology(cr.get_eth_name()).Show(cr.get_thread_options());
+
+  //The kernel of computation
+  if (cr.get_rs_kernel() != "auto" &&
+      !exr::RSComputer::UseKernel(cr.get_rs_kernel()))
+    std::cerr << "Kernel " << cr.get_rs_kernel() << " not supported"
+              << std::endl;
+  std::cout << "Computing with kernel " << exr::RSComputer::GetKernel()
+            << std::endl;
+
   //Create the repairer
   std::cout << "Creating and initializing the repairer..." << std::endl;
   Repairer nr(id, ar.get_total(),
               cr.get_read_file(), cr.get_write_file(),
-              cr.get_mem_num(), cr.get_mem_size(),
+              cr.get_mem_num(), cr.get_mem_size(), cr.get_psize(),
               cr.get_bw_conf_path(), cr.get_eth_name(),
               cr.get_if_print(), cr.get_recv_thr_num(),
-              cr.get_comp_thr_num(), cr.get_proc_thr_num());
+              cr.get_comp_thr_num(), cr.get_proc_thr_num(),
+              cr.get_poll_thr_num(), cr.get_access_options(),
+              cr.get_memory_options(),
+              cr.get_thread_options());
 
   //Connect to other nodes
   std::cout << "Connecting to the other nodes and starting to repair"
             << std::endl;
   nr.Prepare(ar.GetAddresses());
 
-
   //Wait for the tasks to be finished
   nr.WaitForFinish();
   std::cout << std::endl
             << "Received the closing signal, all tasks compeleted"
             << std::endl;
+  nr.ShowStats();
   return 0;
 }
@@ -6,13 +6,11 @@
 namespace exr {
 
 //Constructor and destructor
-ComputeProcessor::ComputeProcessor(const Count &thr_n, MemoryPool &mp,
-                                   DataProcessor<DataPiece> &next_prc)
-    : DataProcessor<DataPiece>(1, thr_n), mp_(mp), next_prc_(next_prc),
-      rc_(2, 1) {
-  RSUnit coefs[2] = {1, 1};
-  rc_.InitForEncode(coefs);
-}
+ComputeProcessor::ComputeProcessor(const Count &thr_n, SlabPool &sp,
+                                   DataProcessor<DataPiece> &next_prc,
+                                   Release release)
+    : DataProcessor<DataPiece>(1, thr_n), sp_(sp), next_prc_(next_prc),
+      release_(std::move(release)) {}
 
 ComputeProcessor::~ComputeProcessor() { Close(); }
 
@@ -21,9 +19,48 @@ Count ComputeProcessor::Distribute(const DataPiece &data) { return 0; }
 
 //Process the data
 void ComputeProcessor::Process(DataPiece data, Count qid) {
+  Consume_(std::move(data), 1);
+}
+
+//Sum the pieces of the same place first in one pass, the later ones are
+//    merged into the first one
+void ComputeProcessor::ProcessBatch(DataPiece *data, const Count &n,
+                                    Count qid) {
+  std::vector<Count> nums(n, 1);
+  std::vector<BufUnit*> srcs(n);
+  std::vector<RSUnit> coefs(n);
+  for (Count i = 0; i < n; ++i) {
+    auto &dp = data[i];
+    if (!dp.buf || nums[i] == 0) continue;
+    srcs[0] = dp.buf;
+    coefs[0] = dp.coef;
+    for (Count j = i + 1; j < n; ++j) {
+      auto &other = data[j];
+      if (!other.buf || other.task_id != dp.task_id ||
+          other.offset != dp.offset || other.lane != dp.lane)
+        continue;
+      srcs[nums[i]] = other.buf;
+      coefs[nums[i]++] = other.coef;
+      nums[j] = 0;
+      dp.tar_id += other.tar_id;
+      dp.src_num += other.src_num;
+      dp.delay_time += other.delay_time;
+      if (other.src_id != 0 && release_) release_(other.src_id);
+    }
+    if (nums[i] > 1) {
+      dp.buf = Sum_(dp.size, nums[i], coefs.data(), srcs.data());
+      dp.coef = 1;
+    }
+  }
+  for (Count i = 0; i < n; ++i)
+    if (nums[i] > 0) Consume_(std::move(data[i]), nums[i]);
+}
+
+void ComputeProcessor::Consume_(DataPiece data, const Count &num) {
   //Get Group, create one if not exist
   auto task_id = data.task_id;
   auto size = data.size;
+  auto src_id = data.buf ? data.src_id : 0;
   std::unique_lock<std::mutex> lck(mtx_);
   auto &pg = task_pieces_[task_id];
   lck.unlock();
@@ -33,10 +70,11 @@ void ComputeProcessor::Process(DataPiece data, Count qid) {
     //Task info
     next_prc_.PushData(std::move(data));
     size = 0 - size;
-  } else if (!AddPiece_(pg, std::move(data))) {
+  } else if (!AddPiece_(pg, std::move(data), num)) {
     //Data piece not sended out
     size = 0;
   }
+  if (src_id != 0 && release_) release_(src_id);
 
   //Check if task ended
   std::unique_lock<std::mutex> rlck(pg.remain_mtx);
@@ -51,46 +89,103 @@ void ComputeProcessor::Process(DataPiece data, Count qid) {
   }
 }
 
-bool ComputeProcessor::AddPiece_(PieceGroup &pg, DataPiece data) {
+bool ComputeProcessor::AddPiece_(PieceGroup &pg, DataPiece data,
+                                 const Count &num) {
   //Get piece, create one if not exist
-  auto offset = data.offset;
+  auto key = data.offset * kMaxLanes + data.lane;
   std::unique_lock<std::mutex> glck(pg.map_mtx);
-  auto &ptp = pg.pieces[offset];
+  auto &ptp = pg.pieces[key];
   if (!ptp) {
     ptp = std::make_unique<TempPiece>(std::move(data), 0);
-    ptp->temp_buf = mp_.Get(0, offset);
     glck.unlock();
   } else {
     glck.unlock();
-    //XOR two pieces and gather the infomation
+    //Add two pieces and gather the infomation
     std::unique_lock<std::mutex> plck(ptp->mtx);
     ptp->dp.tar_id += data.tar_id;
     ptp->dp.delay_time += data.delay_time;
     if (!(ptp->dp.buf)) {
       ptp->dp.size = data.size;
       ptp->dp.buf = data.buf;
+      ptp->dp.coef = data.coef;
     } else if (data.buf) {
-      BufUnit *srcs[2] = {ptp->dp.buf, data.buf},
-              *tars[1] = {ptp->temp_buf};
-      rc_.Encode(data.size, srcs, tars);
-      ptp->dp.buf = ptp->temp_buf;
-      ptp->temp_buf = data.buf;
+      Accumulate_(ptp->dp, data);
     }
     plck.unlock();
   }
 
   //Check if need to send the data out
   std::unique_lock<std::mutex> plck(ptp->mtx);
-  ++(ptp->num);
+  ptp->num += num;
   ptp->src_num += data.src_num;
   if (ptp->src_num == ptp->num) {
+    Apply_(ptp->dp);
     next_prc_.PushData(std::move(ptp->dp));
     plck.unlock();
     glck.lock();
-    pg.pieces.erase(offset);
+    pg.pieces.erase(key);
     return true;
   }
   return false;
 }
 
+//The sum is kept in the slice whose coefficient is applied, the other
+//    piece is multiplied and added to it in place. A local slice shared by
+//    the lanes is only read
+void ComputeProcessor::Accumulate_(DataPiece &sum, DataPiece &data) {
+  auto writable = [&](const DataPiece &dp) {
+    return dp.coef == 1 && !sp_.IsShared(dp.buf);
+  };
+  if (!writable(sum) && writable(data)) {
+    std::swap(sum.buf, data.buf);
+    std::swap(sum.coef, data.coef);
+  }
+  if (writable(sum)) {
+    RSComputer::MulAdd(data.size, data.coef, data.buf, sum.buf);
+    sp_.Put(data.buf);
+  } else {
+    BufUnit *srcs[2] = {sum.buf, data.buf};
+    RSUnit coefs[2] = {sum.coef, data.coef};
+    sum.buf = Sum_(data.size, 2, coefs, srcs);
+    sum.coef = 1;
+  }
+}
+
+//A local piece with nothing added to it still needs its coefficient,
+//    which is applied in place unless the lanes share the slice
+void ComputeProcessor::Apply_(DataPiece &dp) {
+  if (!dp.buf || dp.coef == 1) return;
+  if (sp_.IsShared(dp.buf))
+    dp.buf = Sum_(dp.size, 1, &(dp.coef), &(dp.buf));
+  else
+    RSComputer::Mul(dp.size, dp.coef, dp.buf);
+  dp.coef = 1;
+}
+
+//Waiting for a free slice while holding the sources may never end when
+//    all the slices are held by the pieces waiting to be summed, so the sum
+//    goes into a source not shared if no slice is free
+BufUnit* ComputeProcessor::Sum_(const DataSize &size, const Count &n,
+                                RSUnit *coefs, BufUnit **srcs) {
+  auto sum = sp_.TryGet();
+  Count w = 0;
+  if (!sum) {
+    while (w < n && sp_.IsShared(srcs[w])) ++w;
+    if (w == n) sum = sp_.Get();
+  }
+  if (sum) {
+    RSComputer::DotProd(size, n, coefs, srcs, sum);
+    for (Count k = 0; k < n; ++k) sp_.Put(srcs[k]);
+    return sum;
+  }
+
+  RSComputer::Mul(size, coefs[w], srcs[w]);
+  for (Count k = 0; k < n; ++k) {
+    if (k == w) continue;
+    RSComputer::MulAdd(size, coefs[k], srcs[k], srcs[w]);
+    sp_.Put(srcs[k]);
+  }
+  return srcs[w];
+}
+
 } // namespace exr
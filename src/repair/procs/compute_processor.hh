@@ -1,12 +1,13 @@
 #ifndef EXR_REPAIR_PROCS_COMPUTEPROCESSOR_HH_
 #define EXR_REPAIR_PROCS_COMPUTEPROCESSOR_HH_
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
 
 #include "repair/procs/data_processor.hh"
-#include "util/memory_pool.hh"
+#include "util/slab_pool.hh"
 #include "util/rs_computer.hh"
 #include "util/typedef.hh"
 #include "util/types.hh"
@@ -17,13 +18,13 @@ struct TempPiece {
   DataPiece dp;
   Count num;
   Count src_num;
-  BufUnit *temp_buf;
   std::mutex mtx;
   TempPiece(DataPiece _dp, const Count &_num)
-    : dp(std::move(_dp)), num(_num), src_num(0), temp_buf(nullptr) {}
+    : dp(std::move(_dp)), num(_num), src_num(0) {}
 };
 
 struct PieceGroup {
+  //By offset * kMaxLanes + lane
   std::unordered_map<DataSize, std::unique_ptr<TempPiece>> pieces;
   std::mutex map_mtx;
   DataSize sum;
@@ -32,12 +33,20 @@ struct PieceGroup {
   PieceGroup() : sum(0), total(0) {}
 };
 
-/* A Processor that can collect data pieces and encode */
+/* A Processor that can collect data pieces and encode. A local piece comes
+ * with its coefficient not applied yet, which is done when it is added to
+ * the others: a piece is multiplied and added to the sum in place, and the
+ * pieces of the same place taken in one batch are summed in one pass. The
+ * lanes of a task are summed apart */
 class ComputeProcessor : public DataProcessor<DataPiece>
 {
  public:
-  ComputeProcessor(const Count &thr_n, MemoryPool &mp,
-                   DataProcessor<DataPiece> &next_prc);
+  //Called after a piece from another node is consumed
+  using Release = std::function<void(const Count &src_id)>;
+
+  ComputeProcessor(const Count &thr_n, SlabPool &sp,
+                   DataProcessor<DataPiece> &next_prc,
+                   Release release = nullptr);
   ~ComputeProcessor();
 
   //ComputeProcessor is neither copyable nor movable
@@ -47,16 +56,24 @@ class ComputeProcessor : public DataProcessor<DataPiece>
  protected:
   Count Distribute(const DataPiece &data) override;
   void Process(DataPiece data, Count qid) override;
+  void ProcessBatch(DataPiece *data, const Count &n, Count qid) override;
 
  private:
-  MemoryPool &mp_;
+  SlabPool &sp_;
   DataProcessor<DataPiece> &next_prc_;
+  Release release_;
 
-  RSComputer rc_;
   std::unordered_map<Count, PieceGroup> task_pieces_;
   std::mutex mtx_;
 
-  bool AddPiece_(PieceGroup &pg, DataPiece data);
+  //Consume a piece made of num pieces
+  void Consume_(DataPiece data, const Count &num);
+  bool AddPiece_(PieceGroup &pg, DataPiece data, const Count &num);
+  void Accumulate_(DataPiece &sum, DataPiece &data);
+  void Apply_(DataPiece &dp);
+  //Sum n pieces, the sources are dropped and the slice of the sum returned
+  BufUnit* Sum_(const DataSize &size, const Count &n, RSUnit *coefs,
+                BufUnit **srcs);
 };
 
 } // namespace exr
@@ -3,29 +3,34 @@
 namespace exr {
 
 //Constructor
-template <typename Data>
-DataProcessor<Data>::DataProcessor(const Count &queue_n, const Count &thr_n)
+template <typename Data, typename Queue>
+DataProcessor<Data, Queue>::DataProcessor(const Count &queue_n,
+                                          const Count &thr_n,
+                                          const Count &batch_n)
     : queue_n_(queue_n), on_run_(false),
-      data_queues_(new WaitingQueue<Data>[queue_n]),
-      thr_n_(thr_n), threads_(new std::thread[queue_n * thr_n]) {}
+      data_queues_(new Queue[queue_n]),
+      thr_n_(thr_n), batch_n_(std::max<Count>(batch_n, 1)),
+      threads_(new std::thread[queue_n * thr_n]) {}
 
 //Destructor
-template <typename Data>
-DataProcessor<Data>::~DataProcessor() {
+template <typename Data, typename Queue>
+DataProcessor<Data, Queue>::~DataProcessor() {
   Close();
 }
 
 //Run the processor
-template <typename Data>
-void DataProcessor<Data>::Run() {
+template <typename Data, typename Queue>
+void DataProcessor<Data, Queue>::Run(const ThreadRole &role) {
   on_run_ = true;
   for (Count i = 0; i < queue_n_; ++i) {
     for (Count j = 0; j < thr_n_; ++j) {
-      threads_[i * thr_n_ + j] = std::thread([&, i] {
+      threads_[i * thr_n_ + j] = std::thread([&, i, j, role] {
+        CpuTopology::Place(role, i * thr_n_ + j);
+        std::unique_ptr<Data[]> batch(new Data[batch_n_]);
         while (on_run_) {
-          auto data = std::move(data_queues_[i].Pop());
+          auto n = data_queues_[i].PopBatch(batch.get(), batch_n_);
           if (!on_run_) break;
-          Process(std::move(data), i);
+          ProcessBatch(batch.get(), n, i);
         }
       });
     }
@@ -33,8 +38,8 @@ void DataProcessor<Data>::Run() {
 }
 
 //Close the processor
-template <typename Data>
-void DataProcessor<Data>::Close() {
+template <typename Data, typename Queue>
+void DataProcessor<Data, Queue>::Close() {
   if (on_run_) {
     on_run_ = false;
     for (Count i = 0; i < queue_n_; ++i)
@@ -45,15 +50,25 @@ void DataProcessor<Data>::Close() {
 }
 
 //Distribute the incoming data to a specific processing queue
-template <typename Data>
-void DataProcessor<Data>::PushData(Data data) {
+template <typename Data, typename Queue>
+void DataProcessor<Data, Queue>::PushData(Data data) {
   auto id = Distribute(data);
   if (on_run_) {
-    if (id < queue_n_)
-      data_queues_[id].Push(std::move(data));
-    else
+    if (id >= queue_n_)
       PushData(std::move(data));
+    else
+      data_queues_[id].Push(std::move(data));
   }
 }
 
+template <typename Data, typename Queue>
+void DataProcessor<Data, Queue>::ProcessBatch(Data *data, const Count &n,
+                                              Count qid) {
+  for (Count i = 0; i < n; ++i) Process(std::move(data[i]), qid);
+}
+
+//Static values
+template <typename Data, typename Queue>
+const Count DataProcessor<Data, Queue>::kBatchNum = 16;
+
 } // namespace exr
@@ -1,24 +1,32 @@
 #ifndef EXR_REPAIR_PROCS_DATAPROCESSOR_HH_
 #define EXR_REPAIR_PROCS_DATAPROCESSOR_HH_
 
+#include <algorithm>
 #include <memory>
 #include <thread>
 
+#include "util/cpu_topology.hh"
+#include "util/ring_queue.hh"
 #include "util/typedef.hh"
 #include "util/waiting_queue.hh"
 
 namespace exr {
 
-/* A processor which can use mutithreads to deal with input data */
-template <typename Data>
+/* A processor which can use mutithreads to deal with input data.
+ * The queues are WaitingQueues by default, Queue can be RingQueue.
+ * Each thread takes the data ready in its queue in batches of at most
+ * batch_n, a processor which blocks in Process should take one at a time
+ * to leave the rest to the other threads */
+template <typename Data, typename Queue = WaitingQueue<Data>>
 class DataProcessor
 {
  public:
-  DataProcessor(const Count &queue_n, const Count &thr_n);
+  DataProcessor(const Count &queue_n, const Count &thr_n,
+                const Count &batch_n = kBatchNum);
   ~DataProcessor();
 
-  //Run the processor
-  void Run();
+  //Run the processor, the threads are named and placed as the role
+  void Run(const ThreadRole &role = ThreadRole());
   //Close the processor
   void Close();
   //Add a data into the processor
@@ -35,11 +43,16 @@ class DataProcessor
   virtual Count Distribute(const Data &data) = 0;
   //Process the data
   virtual void Process(Data data, Count qid) = 0;
+  //Process the data taken together in order, one by one if not overridden
+  virtual void ProcessBatch(Data *data, const Count &n, Count qid);
+
+  static const Count kBatchNum;
 
  private:
   bool on_run_; //Whether the processor is still running
-  std::unique_ptr<WaitingQueue<Data>[]> data_queues_;
+  std::unique_ptr<Queue[]> data_queues_;
   Count thr_n_; //Number of threads
+  Count batch_n_; //Most data taken by a thread at a time
   std::unique_ptr<std::thread[]> threads_;
 };
 
@@ -0,0 +1,162 @@
+#include "repair/procs/piece_poller.hh"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "util/cpu_topology.hh"
+
+namespace exr {
+
+//Constructor and destructor
+PiecePoller::PiecePoller(const Count &id, const Count &total,
+                         const Count &thr_n, AccessCenter &ac,
+                         SlabPool &sp, DataProcessor<DataPiece> &next_prc)
+    : id_(id), total_(total), thr_n_(thr_n), ac_(ac), sp_(sp),
+      next_prc_(next_prc), polled_(total, false),
+      epfds_(std::make_unique<int[]>(thr_n)), wake_fd_(-1),
+      on_run_(false), threads_(new std::thread[thr_n]) {}
+
+PiecePoller::~PiecePoller() { Close(); }
+
+//Register the connections to the threads and start polling
+void PiecePoller::Run(const ThreadRole &role) {
+  role_ = role;
+  //Nodes whose connections all have file descriptors are polled
+  for (Count i = 1; i < total_; ++i) {
+    if (i == id_) continue;
+    polled_[i] = true;
+    for (Count s = 0; s < ac_.get_stream_num(); ++s)
+      if (ac_.GetHandle(i, s) < 0) polled_[i] = false;
+    if (!polled_[i]) continue;
+    for (Count s = 0; s < ac_.get_stream_num(); ++s)
+      conns_.push_back({i, s, ac_.GetHandle(i, s), {0, 0, 0, 0}, 0,
+                        nullptr, {}});
+  }
+
+  //Each connection belongs to one thread
+  wake_fd_ = eventfd(0, EFD_NONBLOCK);
+  for (Count t = 0; t < thr_n_; ++t) {
+    epfds_[t] = epoll_create1(0);
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    epoll_ctl(epfds_[t], EPOLL_CTL_ADD, wake_fd_, &ev);
+  }
+  for (size_t i = 0; i < conns_.size(); ++i) {
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = &conns_[i];
+    if (epoll_ctl(epfds_[i % thr_n_], EPOLL_CTL_ADD,
+                  conns_[i].fd, &ev) < 0) {
+      std::cerr << "epoll add error: " << strerror(errno) << std::endl;
+      exit(-1);
+    }
+  }
+
+  on_run_ = true;
+  for (Count t = 0; t < thr_n_; ++t)
+    threads_[t] = std::thread([&, t] {
+      CpuTopology::Place(role_, t);
+      Poll_(t);
+    });
+}
+
+void PiecePoller::Close() {
+  if (on_run_) {
+    on_run_ = false;
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0)
+      std::cerr << "Wake up pollers error" << std::endl;
+    for (Count t = 0; t < thr_n_; ++t) {
+      threads_[t].join();
+      close(epfds_[t]);
+    }
+    close(wake_fd_);
+  }
+}
+
+bool PiecePoller::IsPolled(const Count &src_id) { return polled_[src_id]; }
+
+//Wait for readable connections
+void PiecePoller::Poll_(const Count &tid) {
+  std::unique_ptr<struct epoll_event[]> events(
+      new struct epoll_event[kMaxEvents]);
+  while (on_run_) {
+    auto n = epoll_wait(epfds_[tid], events.get(), kMaxEvents, -1);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      std::cerr << "epoll wait error: " << strerror(errno) << std::endl;
+      exit(-1);
+    }
+    for (int i = 0; i < n; ++i) {
+      auto conn = static_cast<Connection*>(events[i].data.ptr);
+      if (!conn) continue; //Closing
+      if (!ReadAvailable_(*conn))
+        epoll_ctl(epfds_[tid], EPOLL_CTL_DEL, conn->fd, nullptr);
+    }
+  }
+}
+
+//Read until no more data, return false if the connection is closed
+bool PiecePoller::ReadAvailable_(Connection &conn) {
+  while (true) {
+    BufUnit *tar;
+    DataSize size;
+    if (conn.buf && conn.header.length > 0) {
+      tar = conn.packed.data() + conn.got;
+      size = conn.header.length - conn.got;
+    } else if (conn.buf) {
+      tar = conn.buf + conn.got;
+      size = conn.header.size - conn.got;
+    } else {
+      tar = reinterpret_cast<BufUnit*>(&conn.header) + conn.got;
+      size = sizeof(conn.header) - conn.got;
+    }
+
+    if (size > 0) {
+      auto r = recv(conn.fd, tar, size, MSG_DONTWAIT);
+      if (r == 0) return false;
+      if (r < 0) {
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+        std::cerr << "Receive error: " << strerror(errno) << std::endl;
+        return false;
+      }
+      conn.got += r;
+      ac_.CountReceived(conn.src_id, conn.stream, r);
+      if (r < size) continue;
+    }
+
+    //The header or the content is completed
+    conn.got = 0;
+    if (!conn.buf) {
+      //A piece should fit in a slice
+      if (conn.header.size > sp_.get_slice_size()) {
+        std::cerr << "Piece size " << conn.header.size
+                  << " is larger than the slices (" << sp_.get_slice_size()
+                  << ")" << std::endl;
+        exit(-1);
+      }
+      conn.buf = sp_.Get();
+      if (conn.header.length > 0) conn.packed.resize(conn.header.length);
+    } else {
+      if (conn.header.length > 0)
+        ac_.Unpack(conn.src_id, conn.header, conn.packed.data(), conn.buf);
+      next_prc_.PushData({conn.header.task_id, conn.header.offset,
+                          conn.header.size, conn.buf, 0, 0, 0, conn.src_id,
+                          1, conn.header.lane});
+      conn.buf = nullptr;
+    }
+  }
+}
+
+//Static values
+const int PiecePoller::kMaxEvents = 64;
+
+} // namespace exr
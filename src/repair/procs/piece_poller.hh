@@ -0,0 +1,74 @@
+#ifndef EXR_REPAIR_PROCS_PIECEPOLLER_HH_
+#define EXR_REPAIR_PROCS_PIECEPOLLER_HH_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "data/access/access_center.hh"
+#include "repair/procs/data_processor.hh"
+#include "util/slab_pool.hh"
+#include "util/typedef.hh"
+#include "util/types.hh"
+
+namespace exr {
+
+/* Receive pieces from all the other nodes by a few epoll threads,
+ * reading the bytes into the slices as soon as they arrive */
+class PiecePoller
+{
+ public:
+  PiecePoller(const Count &id, const Count &total, const Count &thr_n,
+              AccessCenter &ac, SlabPool &sp,
+              DataProcessor<DataPiece> &next_prc);
+  ~PiecePoller();
+
+  //Start polling, should be called after the connections are built,
+  //    the threads are named and placed as the role
+  void Run(const ThreadRole &role = ThreadRole());
+  //Stop the threads
+  void Close();
+  //Whether the pieces from a node are received by the poller
+  bool IsPolled(const Count &src_id);
+
+  //PiecePoller is neither copyable nor movable
+  PiecePoller(const PiecePoller&) = delete;
+  PiecePoller& operator=(const PiecePoller&) = delete;
+
+ private:
+  //Receiving state of a connection
+  struct Connection {
+    Count src_id;
+    Count stream;
+    int fd;
+    PieceHeader header;
+    DataSize got;   //Received size of the header or the content
+    BufUnit *buf;   //nullptr if receiving the header
+    std::vector<BufUnit> packed; //Compressed content before unpacking
+  };
+
+  Count id_;
+  Count total_;
+  Count thr_n_;
+  AccessCenter &ac_;
+  SlabPool &sp_;
+  DataProcessor<DataPiece> &next_prc_;
+  ThreadRole role_; //Of the epoll threads
+
+  std::vector<Connection> conns_;
+  std::vector<bool> polled_;
+  std::unique_ptr<int[]> epfds_; //One epoll for each thread
+  int wake_fd_;                  //Wake up the threads when closing
+  std::atomic<bool> on_run_;
+  std::unique_ptr<std::thread[]> threads_;
+
+  void Poll_(const Count &tid);
+  bool ReadAvailable_(Connection &conn);
+
+  static const int kMaxEvents;
+};
+
+} // namespace exr
+
+#endif // EXR_REPAIR_PROCS_PIECEPOLLER_HH_
@@ -1,6 +1,7 @@
 #include "repair/procs/proceed_processor.hh"
 
 #include <sys/time.h>
+#include <string>
 #include <thread>
 
 #include "data/file/file_writer.hh"
@@ -10,18 +11,24 @@ namespace exr {
 //Constructor and destructor
 ProceedProcessor::ProceedProcessor(const Count &id, const Count &total,
                                    const Count &thr_n, const Path &path,
-                                   AccessCenter &ac)
-    : DataProcessor<DataPiece>(thr_n, 1), id_(id), ac_(ac), path_(path),
+                                   AccessCenter &ac, SlabPool &sp)
+    : DataProcessor<DataPiece>(thr_n, 1), id_(id), ac_(ac), sp_(sp),
+      path_(path),
       mtxs_(std::make_unique<std::mutex[]>(total)),
-      sizes_(std::make_unique<DataSize[]>(thr_n)) {
+      stream_mtxs_(std::make_unique<std::mutex[]>(
+          total * ac.get_stream_num())),
+      sizes_(std::make_unique<DataSize[]>(thr_n)),
+      targets_(std::make_unique<Count[]>(thr_n)),
+      sents_(std::make_unique<std::vector<BufUnit*>[]>(thr_n)) {
   for (Count i = 0; i < thr_n; ++i) {
     sizes_[i] = 0;
+    targets_[i] = id_;
     free_threads_.push(i);
   }
 }
 
 ProceedProcessor::~ProceedProcessor() {
-  writer_.Close();
+  for (auto &writer : writers_) writer.Close();
   Close();
 }
 
@@ -48,44 +55,120 @@ void ProceedProcessor::Process(DataPiece data, Count qid) {
     if (data.tar_id == id_)
       Store_(data);
     else
-      Send_(data);
+      Send_(&data, 1,
+            ac_.ChooseStream(data.task_id, data.offset, data.size));
+  }
+  Finish_(data, qid);
+}
+
+//A run of pieces to the same connection is sent together, the others are
+//    processed one by one
+void ProceedProcessor::ProcessBatch(DataPiece *data, const Count &n,
+                                    Count qid) {
+  for (Count i = 0; i < n;) {
+    auto &dp = data[i];
+    if (!dp.buf || dp.tar_id == id_) {
+      Process(std::move(dp), qid);
+      ++i;
+      continue;
+    }
+    auto stream = ac_.ChooseStream(dp.task_id, dp.offset, dp.size);
+    Count j = i + 1;
+    while (j < n && data[j].buf && data[j].tar_id == dp.tar_id &&
+           ac_.ChooseStream(data[j].task_id, data[j].offset,
+                            data[j].size) == stream)
+      ++j;
+    Send_(data + i, j - i, stream);
+    for (; i < j; ++i) Finish_(data[i], qid);
+  }
+}
+
+void ProceedProcessor::Finish_(DataPiece &data, const Count &qid) {
+  if (data.buf) {
+    if (data.tar_id == id_) {
+      sp_.Put(data.buf);
+    } else {
+      targets_[qid] = data.tar_id;
+      if (ac_.is_zero_copy()) {
+        sents_[qid].push_back(data.buf);
+        if (sents_[qid].size() >= kMaxSent) Flush_(qid);
+      } else {
+        sp_.Put(data.buf);
+      }
+    }
     sizes_[qid] -= data.size;
   } else {
     sizes_[qid] += data.size;
   }
 
-  //Check if finished
+  //Check if finished, the size of the task may come after the pieces
   if (sizes_[qid] == 0) {
+    //The buffers of the task can be reused only after they are sent out
+    bool stored = targets_[qid] == id_;
+    if (!stored) {
+      Flush_(qid);
+      targets_[qid] = id_;
+    }
     std::unique_lock<std::mutex> lck(mtxs_[0]);
     task_threads_.erase(data.task_id);
-    if (data.tar_id == id_) {
-      ac_.Send(0, sizeof(data.task_id), &(data.task_id));
+    if (stored) {
+      ac_.Control(0).Post(ControlType::kDone, &(data.task_id),
+                          sizeof(data.task_id));
     }
     free_threads_.push(qid);
   }
 }
 
+//The block of lane l is stored to the path with ".l" after it, but lane 0
 void ProceedProcessor::Store_(DataPiece &data) {
   std::unique_lock<std::mutex> lck(mtxs_[id_]);
-  if (!writer_.is_open()) writer_.Open(path_);
-  writer_.Write(data.offset, data.size, data.buf);
+  auto &writer = writers_[data.lane];
+  if (!writer.is_open())
+    writer.Open(data.lane == 0 ? path_
+                               : path_ + "." + std::to_string(data.lane));
+  writer.Write(data.offset, data.size, data.buf);
 }
 
-void ProceedProcessor::Send_(DataPiece &data) {
+//The delay of the pieces is kept after they are sent together
+void ProceedProcessor::Send_(DataPiece *data, const Count &n,
+                             const Count &stream) {
   auto ts = std::chrono::system_clock::now();
 
-  //Send data
-  std::unique_lock<std::mutex> lck(mtxs_[data.tar_id]);
-  ac_.Send(data.tar_id, sizeof(data.task_id), &(data.task_id));
-  ac_.Send(data.tar_id, sizeof(data.offset), &(data.offset));
-  ac_.Send(data.tar_id, sizeof(data.size), &(data.size));
-  ac_.Send(data.tar_id, data.size, data.buf);
+  //Write the pieces to their places in the target's memory
+  static thread_local std::vector<PieceHeader> headers;
+  static thread_local std::vector<void*> bufs;
+  headers.clear();
+  bufs.clear();
+  TTime delay_time = 0;
+  for (Count i = 0; i < n; ++i) {
+    headers.push_back({data[i].task_id, data[i].offset, data[i].size, 0,
+                       data[i].lane});
+    bufs.push_back(data[i].buf);
+    delay_time += data[i].delay_time;
+  }
+  auto tar_id = data[0].tar_id;
+  std::unique_lock<std::mutex> lck(
+      stream_mtxs_[tar_id * ac_.get_stream_num() + stream]);
+  if (n == 1)
+    ac_.SendPiece(tar_id, headers[0], bufs[0], stream);
+  else
+    ac_.SendPieces(tar_id, headers.data(), bufs.data(), n, stream);
   lck.unlock();
 
-  if (data.delay_time > 0) {
-    auto tp = ts + std::chrono::microseconds(data.delay_time);
+  if (delay_time > 0) {
+    auto tp = ts + std::chrono::microseconds(delay_time);
     std::this_thread::sleep_until(tp);
   }
 }
 
+//Wait for the sends, then the slices can be reused
+void ProceedProcessor::Flush_(const Count &qid) {
+  ac_.Flush(targets_[qid]);
+  for (auto buf : sents_[qid]) sp_.Put(buf);
+  sents_[qid].clear();
+}
+
+//Static values
+const size_t ProceedProcessor::kMaxSent = 16;
+
 } // namespace exr
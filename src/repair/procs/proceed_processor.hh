@@ -5,21 +5,25 @@
 #include <mutex>
 #include <unordered_map>
 #include <queue>
+#include <vector>
 
 #include "data/access/access_center.hh"
 #include "data/file/file_writer.hh"
 #include "repair/procs/data_processor.hh"
+#include "util/slab_pool.hh"
 #include "util/typedef.hh"
 #include "util/types.hh"
 
 namespace exr {
 
-/* A Processor that receive DataPieces and send them out */
+/* A Processor that receive DataPieces and send them out, the slices are
+ * returned once they are stored or sent. The pieces taken in one batch
+ * for the same connection are sent in one message */
 class ProceedProcessor : public DataProcessor<DataPiece>
 {
  public:
   ProceedProcessor(const Count &id, const Count &total, const Count &thr_n,
-                   const Path &path, AccessCenter &ac);
+                   const Path &path, AccessCenter &ac, SlabPool &sp);
   ~ProceedProcessor();
 
   //ProceedProcessor is neither copyable nor movable
@@ -29,21 +33,33 @@ class ProceedProcessor : public DataProcessor<DataPiece>
  protected:
   Count Distribute(const DataPiece &data) override;
   void Process(DataPiece data, Count id) override;
+  void ProcessBatch(DataPiece *data, const Count &n, Count qid) override;
 
  private:
   Count id_;
   AccessCenter &ac_;
+  SlabPool &sp_;
   Path path_;
-  FileWriter writer_;
+  FileWriter writers_[kMaxLanes]; //One for the block of each lane
 
   std::unordered_map<Count, Count> task_threads_;
   std::queue<Count> free_threads_;
   std::unique_ptr<std::mutex[]> mtxs_;
+  std::unique_ptr<std::mutex[]> stream_mtxs_; //One for each connection
 
   std::unique_ptr<DataSize[]> sizes_;
+  std::unique_ptr<Count[]> targets_; //Where each thread has sent data to
+  //Slices sent by zero-copy, returned after flushing
+  std::unique_ptr<std::vector<BufUnit*>[]> sents_;
 
   void Store_(DataPiece &data);
-  void Send_(DataPiece &data);
+  //Send n pieces to the same target on the stream
+  void Send_(DataPiece *data, const Count &n, const Count &stream);
+  //Return the slice and check if the task is finished
+  void Finish_(DataPiece &data, const Count &qid);
+  void Flush_(const Count &qid);
+
+  static const size_t kMaxSent;
 };
 
 } // namespace exr
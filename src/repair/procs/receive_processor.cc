@@ -3,23 +3,35 @@
 #include <sys/time.h>
 
 #include "data/file/file_reader.hh"
-#include "util/rs_computer.hh"
 
 namespace exr {
 
-//Constructor and destructor
+//Constructor and destructor, receiving or loading a task blocks the
+//    thread, so each thread takes one task at a time
 ReceiveProcessor::ReceiveProcessor(const Count &total, const Count &id,
                                    const Path &path, const Count &thr_n,
-                                   AccessCenter &ac, MemoryPool &mp,
-                                   DataProcessor<DataPiece> &next_prc)
-    : DataProcessor<ReceiveTask>(1, thr_n),
-      id_(id), path_(path), ac_(ac), mp_(mp), next_prc_(next_prc),
-      remains_(std::make_unique<DataSize[]>(total - 1)) {
-  for (Count i = 0; i < total - 1; ++i)
+                                   AccessCenter &ac, SlabPool &sp,
+                                   DataProcessor<DataPiece> &next_prc,
+                                   const Count &poll_thr_n)
+    : DataProcessor<ReceiveTask>(1, thr_n, 1),
+      id_(id), path_(path), ac_(ac), sp_(sp), next_prc_(next_prc),
+      stream_num_(ac.get_stream_num()),
+      remains_(std::make_unique<DataSize[]>((total - 1) * stream_num_)) {
+  for (Count i = 0; i < (total - 1) * stream_num_; ++i)
     remains_[i] = 0;
+  if (poll_thr_n > 0)
+    poller_ = std::make_unique<PiecePoller>(id, total, poll_thr_n,
+                                            ac, sp, next_prc);
 }
 
-ReceiveProcessor::~ReceiveProcessor() { Close(); }
+ReceiveProcessor::~ReceiveProcessor() {
+  Close();
+  if (poller_) poller_->Close();
+}
+
+void ReceiveProcessor::StartPolling(const ThreadRole &role) {
+  if (poller_) poller_->Run(role);
+}
 
 //Distribute
 Count ReceiveProcessor::Distribute(const ReceiveTask &data) { return 0; }
@@ -35,58 +47,63 @@ void ReceiveProcessor::Process(ReceiveTask data, Count qid) {
 
 //Load data from local
 void ReceiveProcessor::LoadData_(ReceiveTask data) {
-  //Send task's size to the next processor
+  //Send task's size to the next processor, a piece for each lane
   auto t = std::chrono::system_clock::now();
-  next_prc_.PushData({data.rt.task_id, 0, data.rt.size, nullptr, 0, 0, 0});
+  auto lanes = data.rt.lane_num;
+  next_prc_.PushData({data.rt.task_id, 0, data.rt.size * lanes, nullptr, 0,
+                      0, 0});
 
   //Initialization
-  RSComputer rc(1, 1);
   exr::FileReader reader;
-  BufUnit *buf = nullptr, *temp_buf = nullptr;
   DataSize remain = data.rt.size, offset = data.rt.offset, size = 0;
 
   //Check if need to load data
-  if (data.rt.tar_id != id_) {
-    rc.InitForEncode(&(data.rt.coef));
+  bool load = data.rt.tar_id != id_;
+  if (load) {
     reader.Open(path_);
     reader.SetOffset(offset);
-    buf = mp_.Get(id_, offset);
-    temp_buf = mp_.Get(data.rt.tar_id, offset);
   }
 
+  //Pieces are paced by the bandwidth of the task, unless the traffic is
+  //    shaped by the token buckets of the access center already
+  bool paced = data.rt.bandwidth > 0 && !ac_.is_token_bucket();
   TTime dt = 0;
   size = data.rt.piece_size;
-  if (data.rt.bandwidth > 0)
+  if (paced)
     dt = static_cast<TTime>((size * 8000.0) / data.rt.bandwidth);
-  //Load pieces
+  //Load pieces, read once and shared by the lanes
   while (remain > 0) {
-    DataPiece dp{data.rt.task_id, offset, 0, buf, data.rt.tar_id,
+    DataPiece dp{data.rt.task_id, offset, 0, nullptr, data.rt.tar_id,
                  data.rt.src_num, dt};
     if (remain < size) {
       size = remain;
-      if (data.rt.bandwidth > 0)
+      if (paced)
         dt = static_cast<TTime>((size * 8000.0) / data.rt.bandwidth);
     }
 
-    if (buf) {
+    if (load) {
+      //Load data, it is multiplied by the coefficient when computing
       dp.size = size;
-      //Load data
-      auto s = reader.Read(size, temp_buf);
+      dp.buf = GetSlice_(size);
+      auto s = reader.Read(size, dp.buf);
       if (s != size) {
         std::cerr << "File is not big enough for reading..." << std::endl;
         exit(-1);
       }
-      //Multiply
-      BufUnit *srcs[1] = {temp_buf}, *tars[1] = {dp.buf};
-      rc.Encode(size, srcs, tars);
-      buf += size;
-      temp_buf += size;
       //Wait
-      t += std::chrono::microseconds(dt);
+      t += std::chrono::microseconds(dt * lanes);
       std::this_thread::sleep_until(t);
     }
 
-    next_prc_.PushData(std::move(dp));
+    for (Count l = 0; l < lanes; ++l) {
+      DataPiece lp = dp;
+      lp.lane = l;
+      if (load) {
+        lp.coef = data.rt.GetCoef(l);
+        if (l > 0) sp_.Ref(lp.buf);
+      }
+      next_prc_.PushData(std::move(lp));
+    }
     remain -= size;
     offset += size;
   }
@@ -94,28 +111,80 @@ void ReceiveProcessor::LoadData_(ReceiveTask data) {
 
 //Get pieces from other nodes
 void ReceiveProcessor::ReceiveData_(ReceiveTask data) {
+  //The pieces are pushed by the poller once they arrive
+  if (poller_ && poller_->IsPolled(data.src_id)) return;
+
   std::unique_lock<std::mutex> lck(mtx_);
-  remains_[data.src_id - 1] += data.rt.size;
-  //If a task of the same source is running, this thread needn't do anything
-  if (remains_[data.src_id - 1] > data.rt.size)
-    return;
+  auto base = (data.src_id - 1) * stream_num_;
+  if (data.rt.size > 0) {
+    //Add the task to each connection's remain size,
+    //    connections that are not being received need threads
+    auto shares = GetStreamShares_(data.rt);
+    std::vector<Count> idles;
+    for (Count s = 0; s < stream_num_; ++s) {
+      remains_[base + s] += shares[s];
+      if (shares[s] > 0 && remains_[base + s] == shares[s])
+        idles.push_back(s);
+    }
+    lck.unlock();
+    //If a task of the same connection is running, needn't do anything
+    if (idles.empty()) return;
+    data.stream = idles[0];
+    for (size_t i = 1; i < idles.size(); ++i) {
+      RepairTask rt = data.rt;
+      rt.size = 0;
+      PushData({rt, data.src_id, idles[i]});
+    }
+    lck.lock();
+  }
 
-  while (remains_[data.src_id - 1] > 0) {
+  auto &remain = remains_[base + data.stream];
+  while (remain > 0) {
     lck.unlock();
 
-    DataPiece dp{0, 0, 0, nullptr, 0, 0, 0};
-    ac_.Receive(data.src_id, sizeof(dp.task_id), &(dp.task_id));
-    ac_.Receive(data.src_id, sizeof(dp.offset), &(dp.offset));
-    ac_.Receive(data.src_id, sizeof(dp.size), &(dp.size));
-    dp.buf = mp_.Get(data.src_id, dp.offset);
-    ac_.Receive(data.src_id, dp.size, dp.buf);
+    //Get the header, then put the content into a slice directly
+    PieceHeader header;
+    ac_.Receive(data.src_id, sizeof(header), &header, data.stream);
+    DataPiece dp{header.task_id, header.offset, header.size,
+                 GetSlice_(header.size), 0, 0, 0, data.src_id, 1,
+                 header.lane};
+    ac_.ReceiveContent(data.src_id, header, dp.buf, data.stream);
 
     auto size = dp.size;
     next_prc_.PushData(std::move(dp));
 
     lck.lock();
-    remains_[data.src_id - 1] -= size;
+    remain -= size;
+  }
+}
+
+//A piece should fit in a slice
+BufUnit* ReceiveProcessor::GetSlice_(const DataSize &size) {
+  if (size > sp_.get_slice_size()) {
+    std::cerr << "Piece size " << size << " is larger than the slices ("
+              << sp_.get_slice_size() << ")" << std::endl;
+    exit(-1);
+  }
+  return sp_.Get();
+}
+
+//Get the size of a task that each connection will carry
+std::vector<DataSize> ReceiveProcessor::GetStreamShares_(
+    const RepairTask &rt) {
+  std::vector<DataSize> shares(stream_num_, 0);
+  if (stream_num_ == 1) {
+    shares[0] = rt.size * rt.lane_num;
+    return shares;
+  }
+  //Choose the connection of each piece as the sender does
+  DataSize offset = rt.offset, remain = rt.size;
+  while (remain > 0) {
+    auto size = remain < rt.piece_size ? remain : rt.piece_size;
+    shares[ac_.ChooseStream(rt.task_id, offset, size)] += size * rt.lane_num;
+    offset += size;
+    remain -= size;
   }
+  return shares;
 }
 
 } // namespace exr
@@ -3,10 +3,12 @@
 
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "data/access/access_center.hh"
 #include "repair/procs/data_processor.hh"
-#include "util/memory_pool.hh"
+#include "repair/procs/piece_poller.hh"
+#include "util/slab_pool.hh"
 #include "util/typedef.hh"
 #include "util/types.hh"
 
@@ -18,10 +20,16 @@ class ReceiveProcessor : public DataProcessor<ReceiveTask>
  public:
   ReceiveProcessor(const Count &total, const Count &id,
                    const Path &path, const Count &thr_n,
-                   AccessCenter &ac, MemoryPool &mp,
-                   DataProcessor<DataPiece> &next_prc);
+                   AccessCenter &ac, SlabPool &sp,
+                   DataProcessor<DataPiece> &next_prc,
+                   const Count &poll_thr_n = 0);
   ~ReceiveProcessor();
 
+  //Receive the pieces from other nodes by epoll threads if enabled,
+  //    should be called after the connections are built, the polling
+  //    threads are named and placed as the role
+  void StartPolling(const ThreadRole &role = ThreadRole());
+
   //ReceiveProcessor is neither copyable nor movable
   ReceiveProcessor(const ReceiveProcessor&) = delete;
   ReceiveProcessor& operator=(const ReceiveProcessor&) = delete;
@@ -34,15 +42,21 @@ class ReceiveProcessor : public DataProcessor<ReceiveTask>
   Count id_;
   Path path_;
   AccessCenter &ac_;
-  MemoryPool &mp_;
+  SlabPool &sp_;
   DataProcessor<DataPiece> &next_prc_;
 
-  //The remain size to receive of each node
+  //The remain size to receive of each node's each connection
+  Count stream_num_;
   std::unique_ptr<DataSize[]> remains_;
   std::mutex mtx_;
 
+  //nullptr if each connection is received by a blocking thread
+  std::unique_ptr<PiecePoller> poller_;
+
   void LoadData_(ReceiveTask data);
   void ReceiveData_(ReceiveTask data);
+  BufUnit* GetSlice_(const DataSize &size);
+  std::vector<DataSize> GetStreamShares_(const RepairTask &rt);
 };
 
 } // namespace exr
@@ -1,8 +1,9 @@
+#include <cstring>
 #include <iostream>
 #include <thread>
 
 #include "repair/procs/compute_processor.hh"
-#include "util/memory_pool.hh"
+#include "util/slab_pool.hh"
 #include "util/typedef.hh"
 #include "util/types.hh"
 
@@ -43,9 +44,9 @@ int main()
   exr::BufUnit buf[30] = "abcdefghijklmnopqrstuvwxyz";
 
   //Initialization
-  exr::MemoryPool mp(buf_n, buf_size);
+  exr::SlabPool sp(buf_size, buf_n);
   DataShower ds;
-  exr::ComputeProcessor cp(thr_n, mp, ds);
+  exr::ComputeProcessor cp(thr_n, sp, ds);
   ds.Run();
   cp.Run();
 
@@ -54,8 +55,10 @@ int main()
   for (exr::Count i = 0; i < src_num * pn * times; ++i) {
     ts[i] = std::thread([&, i] {
       exr::Count tid = i / (src_num * pn), pid = i % pn;
+      auto slice = sp.Get();
+      memcpy(slice, buf + pid * psize, psize);
       cp.PushData({tid, tid * pn * psize + pid * psize, psize,
-                   buf + pid * psize, 0, 0, 0});
+                   slice, 0, 0, 0});
     });
   }
   std::thread lt[pn * times];
@@ -79,5 +82,28 @@ int main()
   for (exr::Count i = 0; i < times; ++i) it[i].join();
 
   std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  //Only the slices of the results are still in use
+  std::cout << "Slices in use: " << sp.get_num() - sp.get_free_num()
+            << ", at most: " << sp.get_peak_num() << std::endl;
+
+  //Every slice is held by a piece to sum, the sum goes into one of them
+  const exr::Count few = 4;
+  exr::SlabPool sp2(buf_size, few);
+  DataShower ds2;
+  exr::ComputeProcessor cp2(1, sp2, ds2);
+  exr::BufUnit *slices[few];
+  for (exr::Count i = 0; i < few; ++i) {
+    slices[i] = sp2.Get();
+    memcpy(slices[i], buf + i, psize);
+  }
+  ds2.Run();
+  cp2.Run();
+  cp2.PushData({9, 0, psize, nullptr, 0, 0, 0});
+  cp2.PushData({9, 0, 0, nullptr, 1, few + 1, 0});
+  for (exr::Count i = 0; i < few; ++i)
+    cp2.PushData({9, 0, psize, slices[i], 0, 0, 0, 0, 3});
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  std::cout << "Summed with all the slices held, in use: "
+            << sp2.get_num() - sp2.get_free_num() << std::endl;
   return 0;
 }
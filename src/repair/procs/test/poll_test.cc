@@ -0,0 +1,89 @@
+#include <array>
+#include <iostream>
+#include <thread>
+
+#include "data/access/access_center.hh"
+#include "repair/procs/data_processor.hh"
+#include "repair/procs/piece_poller.hh"
+#include "util/slab_pool.hh"
+#include "util/typedef.hh"
+#include "util/types.hh"
+
+//To show what the output is
+class DataShower : public exr::DataProcessor<exr::DataPiece> {
+ public:
+  DataShower(exr::SlabPool &sp)
+      : exr::DataProcessor<exr::DataPiece>(1, 1), sp_(&sp) {}
+  ~DataShower() = default;
+
+ protected:
+  exr::Count Distribute(const exr::DataPiece &data) override { return 0; }
+  void Process(exr::DataPiece data, exr::Count pid) override {
+    std::cout << "Detected a new DataPiece:" << std::endl
+              << "\ttask_id:   " << data.task_id << std::endl
+              << "\toffset:    " << data.offset << std::endl
+              << "\tsize:      " << data.size << std::endl
+              << "\tsrc_id:    " << data.src_id << std::endl
+              << "\tcontent:   ";
+    std::cout.write(data.buf, data.size);
+    std::cout << std::endl << std::endl;
+    sp_->Put(data.buf);
+  }
+
+ private:
+  exr::SlabPool *sp_;
+};
+
+//Main
+int main()
+{
+  //Parameters
+  const exr::Count total = 4, id = 1, thr_n = 2, buf_n = 100;
+  auto ip_ads = exr::IPAddressList(new exr::IPAddress[total]{
+      {"localhost", 10086},
+      {"localhost", 10087},
+      {"localhost", 10088},
+      {"localhost", 10089}
+  });
+  exr::DataSize buf_size = 1 << 10;
+
+  //Network connection
+  std::thread t[total];
+  std::array<exr::AccessCenter, total> ac = { {{0, total}, {1, total},
+                                               {2, total}, {3, total}} };
+  for (int i = 0; i < total; ++i) {
+    t[i] = std::thread([&, i] {
+      ac[i].Connect(ip_ads);
+    });
+  }
+  for (int i = 0; i < total; ++i)
+    t[i].join();
+  std::cout << "Connected" << std::endl;
+
+  //Initialization
+  exr::SlabPool sp(buf_size, buf_n);
+  DataShower ds(sp);
+  exr::PiecePoller pp(id, total, thr_n, ac[id], sp, ds);
+  ds.Run();
+  pp.Run();
+  std::cout << "Polled: " << pp.IsPolled(0) << pp.IsPolled(2)
+            << pp.IsPolled(3) << std::endl << std::endl;
+
+  //Pieces from two nodes, the header and the content are split
+  exr::PieceHeader header{2, 80, 5, 0, 0};
+  exr::BufUnit temp_buf[20] = "abcdefghijk";
+  std::cout << "Sending a piece in two parts" << std::endl;
+  ac[2].Send(id, sizeof(header), &header);
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  ac[2].Send(id, header.size, temp_buf);
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  std::cout << "Sending pieces from two nodes" << std::endl;
+  exr::BufUnit temp_buf2[20] = "ABCDEFGHIJK";
+  ac[3].SendPiece(id, {3, 256, 10, 0, 0}, temp_buf2);
+  ac[2].SendPiece(id, {2, 85, 5, 0, 0}, temp_buf + 5);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+  pp.Close();
+  return 0;
+}
@@ -1,12 +1,14 @@
 #include <array>
+#include <cstring>
 #include <iostream>
 #include <sys/time.h>
 #include <thread>
 
 #include "data/access/access_center.hh"
 #include "repair/procs/proceed_processor.hh"
-#include "util/memory_pool.hh"
+#include "util/slab_pool.hh"
 #include "util/typedef.hh"
+#include "util/types.hh"
 
 int main()
 {
@@ -33,9 +35,16 @@ int main()
   std::cout << "Connected" << std::endl;
 
   //Initialization
-  exr::ProceedProcessor pp(id, total, thr_n, path, ac[id]);
+  exr::SlabPool sp(buf_size, 64);
+  exr::ProceedProcessor pp(id, total, thr_n, path, ac[id], sp);
   struct timeval start_time, end_time;
   exr::BufUnit buf[buf_size] = "abcdefghijklmnopgrstuvwxyz";
+  //The pieces are in slices, returned by pp
+  auto slice = [&](const exr::DataSize &s) {
+    auto p = sp.Get();
+    memcpy(p, buf, s);
+    return p;
+  };
   pp.Run();
   exr::DataSize size, psize, remain;
   exr::BwType bandwidth;
@@ -46,8 +55,9 @@ int main()
   bandwidth = 250000;
   std::cout << std::endl << "Single send task test started" << std::endl;
   t[0] = std::thread([&] {
-    exr::Count task_id;
-    ac[0].Receive(2, sizeof(task_id), &task_id);
+    exr::ControlChannel::Message msg;
+    ac[0].Control(2).Take(exr::ControlType::kDone, msg);
+    auto task_id = *reinterpret_cast<exr::Count*>(msg.data());
     gettimeofday(&end_time, nullptr);
     double duration = (end_time.tv_sec - start_time.tv_sec) * 1e6 +
                       (end_time.tv_usec - start_time.tv_usec);
@@ -58,24 +68,23 @@ int main()
               << std::endl;
   });
   t[1] = std::thread([&] {
-    exr::Count tt;
-    exr::DataSize nn = 0, oo, ss;
+    exr::PieceHeader hh;
+    exr::DataSize nn = 0;
     exr::BufUnit bb[buf_size];
     while (nn < size) {
-      ac[2].Receive(id, sizeof(tt), &tt);
-      ac[2].Receive(id, sizeof(oo), &oo);
-      ac[2].Receive(id, sizeof(ss), &ss);
-      ac[2].Receive(id, ss, bb);
-      nn += ss;
+      ac[2].Receive(id, sizeof(hh), &hh);
+      ac[2].Receive(id, hh.size, bb);
+      nn += hh.size;
     }
-    ac[2].Send(0, sizeof(tt), &tt);
+    ac[2].Control(0).Post(exr::ControlType::kDone, &(hh.task_id),
+                          sizeof(hh.task_id));
   });
   pp.PushData({5, 0, size, nullptr, 0, 0, 0});
   gettimeofday(&start_time, nullptr);
   remain = size;
   while (remain > 0) {
     auto s = remain > psize ? psize : remain;
-    pp.PushData({5, size - remain, s, buf, 2, 1, bandwidth});
+    pp.PushData({5, size - remain, s, slice(s), 2, 1, bandwidth});
     remain -= s;
   }
   t[0].join();
@@ -87,8 +96,9 @@ int main()
   bandwidth = 250000;
   std::cout << std::endl << "Single store task test started" << std::endl;
   t[0] = std::thread([&] {
-    exr::Count task_id;
-    ac[0].Receive(id, sizeof(task_id), &task_id);
+    exr::ControlChannel::Message msg;
+    ac[0].Control(id).Take(exr::ControlType::kDone, msg);
+    auto task_id = *reinterpret_cast<exr::Count*>(msg.data());
     gettimeofday(&end_time, nullptr);
     double duration = (end_time.tv_sec - start_time.tv_sec) * 1e6 +
                       (end_time.tv_usec - start_time.tv_usec);
@@ -103,7 +113,7 @@ int main()
   remain = size;
   while (remain > 0) {
     auto s = remain > psize ? psize : remain;
-    pp.PushData({9, size - remain, s, buf, id, 0, bandwidth});
+    pp.PushData({9, size - remain, s, slice(s), id, 0, bandwidth});
     remain -= s;
   }
   t[0].join();
@@ -117,8 +127,10 @@ int main()
   std::mutex mtx;
   for (exr::Count i = 0; i < 2; ++i) {
     tint[i] = std::thread([&, i] {
-      exr::Count ftid, eid = i + 2;
-      ac[0].Receive(eid, sizeof(ftid), &ftid);
+      exr::Count eid = i + 2;
+      exr::ControlChannel::Message msg;
+      ac[0].Control(eid).Take(exr::ControlType::kDone, msg);
+      auto ftid = *reinterpret_cast<exr::Count*>(msg.data());
       struct timeval etime;
       gettimeofday(&etime, nullptr);
       double duration = (etime.tv_sec - start_time.tv_sec) * 1e6 +
@@ -133,17 +145,16 @@ int main()
   }
   for (int i = 0; i < 2; ++i) {
     trec[i] = std::thread([&, i] {
-      exr::Count tt;
-      exr::DataSize oo, ss, nn = 0;
+      exr::PieceHeader hh;
+      exr::DataSize nn = 0;
       exr::BufUnit bb[buf_size];
       while (nn < size) {
-        ac[i + 2].Receive(id, sizeof(tt), &tt);
-        ac[i + 2].Receive(id, sizeof(oo), &oo);
-        ac[i + 2].Receive(id, sizeof(ss), &ss);
-        ac[i + 2].Receive(id, ss, bb);
-        nn += ss;
+        ac[i + 2].Receive(id, sizeof(hh), &hh);
+        ac[i + 2].Receive(id, hh.size, bb);
+        nn += hh.size;
       }
-      ac[i + 2].Send(0, sizeof(tt), &tt);
+      ac[i + 2].Control(0).Post(exr::ControlType::kDone, &(hh.task_id),
+                                sizeof(hh.task_id));
     });
   }
   gettimeofday(&start_time, nullptr);
@@ -153,7 +164,7 @@ int main()
       auto rr = size;
       while (rr > 0) {
         auto s = rr > psize ? psize : rr;
-        pp.PushData({i, size - rr, s, buf, ttiidd, 0, bandwidth});
+        pp.PushData({i, size - rr, s, slice(s), ttiidd, 0, bandwidth});
         rr -= s;
       }
     });
@@ -166,6 +177,10 @@ int main()
     t_t[i].join();
   }
 
+  //All the slices are returned after sending or storing
+  std::cout << "Slices in use: " << sp.get_num() - sp.get_free_num()
+            << ", at most: " << sp.get_peak_num() << std::endl;
+
   //Cleaning
   auto _ = system(("rm " + path).c_str());
   ++_;
@@ -5,7 +5,7 @@
 #include "data/access/access_center.hh"
 #include "repair/procs/data_processor.hh"
 #include "repair/procs/receive_processor.hh"
-#include "util/memory_pool.hh"
+#include "util/slab_pool.hh"
 #include "util/typedef.hh"
 #include "util/types.hh"
 
@@ -66,9 +66,9 @@ int main()
   std::cout << "Connected" << std::endl;
 
   //Initialization
-  exr::MemoryPool mp(buf_n, buf_size);
+  exr::SlabPool sp(buf_size, buf_n);
   DataShower ds;
-  exr::ReceiveProcessor rp(total, id, path, thr_n, ac[id], mp, ds);
+  exr::ReceiveProcessor rp(total, id, path, thr_n, ac[id], sp, ds);
   ds.Run();
   rp.Run();
 
@@ -84,13 +84,10 @@ int main()
   std::cout << "Start network receiving test..." << std::endl << std::endl;
 
   std::cout << "Sending a piece" << std::endl;
-  exr::Count task_id = 2;
-  exr::DataSize offset = 80, size = 5;
+  exr::PieceHeader header{2, 80, 5};
   exr::BufUnit temp_buf[20] = "abcdefghijk";
-  ac[2].Send(id, sizeof(task_id), &task_id);
-  ac[2].Send(id, sizeof(offset), &offset);
-  ac[2].Send(id, sizeof(size), &size);
-  ac[2].Send(id, size, temp_buf);
+  ac[2].Send(id, sizeof(header), &header);
+  ac[2].Send(id, header.size, temp_buf);
   std::this_thread::sleep_for(std::chrono::milliseconds(1000));
 
   std::cout << "Pushing a task" << std::endl;
@@ -98,21 +95,16 @@ int main()
   std::this_thread::sleep_for(std::chrono::milliseconds(1000));
 
   std::cout << "Sending a piece" << std::endl;
-  exr::Count task_id2 = 3;
-  exr::DataSize offset2 = 256, size2 = 10;
+  exr::PieceHeader header2{3, 256, 10};
   exr::BufUnit temp_buf2[20] = "ABCDEFGHIJK";
-  ac[2].Send(id, sizeof(task_id2), &task_id2);
-  ac[2].Send(id, sizeof(offset2), &offset2);
-  ac[2].Send(id, sizeof(size2), &size2);
-  ac[2].Send(id, size2, temp_buf2);
+  ac[2].Send(id, sizeof(header2), &header2);
+  ac[2].Send(id, header2.size, temp_buf2);
   std::this_thread::sleep_for(std::chrono::milliseconds(1000));
 
   std::cout << "Sending a piece" << std::endl;
-  offset += size;
-  ac[2].Send(id, sizeof(task_id), &task_id);
-  ac[2].Send(id, sizeof(offset), &offset);
-  ac[2].Send(id, sizeof(size), &size);
-  ac[2].Send(id, size, temp_buf + size);
+  header.offset += header.size;
+  ac[2].Send(id, sizeof(header), &header);
+  ac[2].Send(id, header.size, temp_buf + header.size);
   std::this_thread::sleep_for(std::chrono::milliseconds(1000));
 
   std::cout << "Pushing a task" << std::endl;
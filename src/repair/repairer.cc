@@ -1,85 +1,111 @@
 #include "repair/repairer.hh"
 
+#include <algorithm>
+#include <iostream>
+
 namespace exr {
 
 //Constructor
 Repairer::Repairer(const Count &id, const Count &total,
                    const Path &load_path, const Path &store_path,
                    const Count &block_num, const DataSize &size,
-                   const Path &bandwidth_path, const Name &eth_name,
-                   const bool &if_print, const Count &recv_thr_num,
-                   const Count &comp_thr_num, const Count &proc_thr_num)
-    : id_(id), ac_(id, total), mp_(block_num, size),
-      proceeder_(id, total, proc_thr_num, store_path, ac_),
-      computer_(comp_thr_num, mp_, proceeder_),
-      receiver_(total, id, load_path, recv_thr_num, ac_, mp_, computer_),
-      bs_(eth_name, if_print), bandwidth_path_(bandwidth_path),
+                   const DataSize &slice_size, const Path &bandwidth_path,
+                   const Name &eth_name, const bool &if_print,
+                   const Count &recv_thr_num, const Count &comp_thr_num,
+                   const Count &proc_thr_num, const Count &poll_thr_num,
+                   const AccessOptions &options,
+                   const MemoryOptions &mem_options,
+                   const ThreadOptions &threads)
+    : id_(id), total_(total), ac_(id, total, options),
+      sp_(slice_size, block_num * size / slice_size, mem_options),
+      proceeder_(id, total, proc_thr_num, store_path, ac_, sp_),
+      computer_(comp_thr_num, sp_, proceeder_,
+                [&](const Count &src_id) { ac_.ReleaseCredit(src_id); }),
+      receiver_(total, id, load_path, recv_thr_num, ac_, sp_, computer_,
+                poll_thr_num),
+      threads_(threads), bs_(eth_name, if_print, options.token_bucket),
+      bandwidth_path_(bandwidth_path), token_bucket_(options.token_bucket),
       on_run_(false) {}
 
 //Destructor: to be sure that all the threads is already closed
 Repairer::~Repairer() { WaitForFinish(); }
 
-//Connect to other nodes and start the threads
+//Connect to other nodes, start the threads and the handlers of the
+//    messages from the master
 void Repairer::Prepare(const IPAddressList &ip_addresses) {
   ac_.Connect(ip_addresses);
-  receiver_.Run();
-  computer_.Run();
-  proceeder_.Run();
+  auto poll = threads_.recv;
+  poll.name = "poll";
+  receiver_.StartPolling(poll);
+  receiver_.Run(threads_.recv);
+  computer_.Run(threads_.comp);
+  proceeder_.Run(threads_.proc);
 
   std::unique_lock<std::mutex> lck(mtx_);
-  task_getter_ = std::thread([&] { GetTaks(); });
   on_run_ = true;
+  lck.unlock();
+  auto &master = ac_.Control(0);
+  using Message = ControlChannel::Message;
+  master.On(ControlType::kTask, [&](const Message &msg) { OnTask_(msg); });
+  //Setting the bandwidth runs commands and reads files, which is slow
+  master.On(ControlType::kBandwidth,
+            [&](const Message &msg) { OnBandwidth_(msg); }, true);
+  master.On(ControlType::kReload, [&](const Message &msg) {
+    bs_.Open(bandwidth_path_);
+    ac_.Control(0).Post(ControlType::kAck);
+  }, true);
+  master.On(ControlType::kStats, [&](const Message &msg) {
+    auto traffic = ac_.GetTraffic();
+    ac_.Control(0).Post(ControlType::kStats, &traffic, sizeof(traffic));
+  });
+  master.On(ControlType::kShutdown, [&](const Message &msg) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    on_run_ = false;
+    cv_.notify_all();
+  });
 }
 
 //Used by creator to wait for this repairer closed by the master node
 void Repairer::WaitForFinish() {
   std::unique_lock<std::mutex> lck(mtx_);
-  if (on_run_) {
-    task_getter_.join();
-    on_run_ = false;
-  }
+  cv_.wait(lck, [&] { return !on_run_; });
 }
 
-//Get tasks from the master
-void Repairer::GetTaks() {
-  RepairTask rt;
-  Count src_id;
-  while (true) {
-    //Get from master and check if can quit
-    ac_.Receive(0, sizeof(rt), &rt);
-    if (rt.size == 0) {
-      if (rt.piece_size == 0) {
-        //No more task, the repair is ended
-        break;
-      } else {
-        //Bandwidth
-        if (rt.offset > 0) {
-          //Need to reopen the bandwidhth file
-          bs_.Open(bandwidth_path_);
-        } else {
-          //Load the bandwidth and set it
-          if (!bs_.LoadNext()) {
-            std::cerr << "Load bandwidth error" << std::endl;
-            exit(-1);
-          }
-          bs_.SetBandwidth(id_, rt.bandwidth == 0);
-        }
-        //Tell the master that is already finished
-        ac_.Send(0, sizeof(src_id), &src_id);
-        continue;
-      }
-    }
+void Repairer::ShowStats() {
+  ac_.ShowStats();
+  std::cout << "Slices of node " << id_ << ": " << sp_.get_peak_num()
+            << " of " << sp_.get_num() << " in use at most" << std::endl;
+}
+
+//A task with the ids of its sources, deliver to the processors
+void Repairer::OnTask_(const ControlChannel::Message &msg) {
+  RepairTask rt = *reinterpret_cast<const RepairTask*>(msg.data());
+  auto srcs = reinterpret_cast<const Count*>(msg.data() + sizeof(rt));
+  rt.src_num += 1;
+  receiver_.PushData({rt, id_, 0});
+  for (Count i = 1; i < rt.src_num; ++i)
+    receiver_.PushData({rt, srcs[i - 1], 0});
+}
 
-    //Has a new task, deliver to the processors
-    rt.src_num += 1;
-    receiver_.PushData({rt, id_});
-    for (Count i = 1; i < rt.src_num; ++i) {
-      ac_.Receive(0, sizeof(src_id), &src_id);
-      receiver_.PushData({rt, src_id});
-    }
-    //if (rt.tar_id == id_) rt.piece_size = 0 - rt.piece_size;
-    //receiver_.PushData({rt, id_});
+//Load the next bandwidths and set them, the requestor's is full
+void Repairer::OnBandwidth_(const ControlChannel::Message &msg) {
+  bool is_full = *reinterpret_cast<const bool*>(msg.data());
+  if (!bs_.LoadNext()) {
+    std::cerr << "Load bandwidth error" << std::endl;
+    exit(-1);
+  }
+  if (token_bucket_)
+    ac_.SetBandwidth(bs_.GetBandwidth(id_, is_full));
+  else
+    bs_.SetBandwidth(id_, is_full);
+  //A link is as fast as the upload here and the download there
+  auto own = bs_.GetBandwidth(id_, is_full);
+  for (Count i = 1; i < total_; ++i) {
+    if (i == id_) continue;
+    ac_.SetLinkBandwidth(i, std::min(own.upload,
+                         bs_.GetBandwidth(i, false).download));
   }
+  ac_.Control(0).Post(ControlType::kAck);
 }
 
-} // namespace exprocessors
+} // namespace exr
@@ -1,16 +1,16 @@
 #ifndef EXR_REPAIR_REPAIRER_HH_
 #define EXR_REPAIR_REPAIRER_HH_
 
+#include <condition_variable>
 #include <memory>
 #include <mutex>
-#include <thread>
 
 #include "config/bandwidth_solver.hh"
 #include "data/access/access_center.hh"
 #include "repair/procs/compute_processor.hh"
 #include "repair/procs/receive_processor.hh"
 #include "repair/procs/proceed_processor.hh"
-#include "util/memory_pool.hh"
+#include "util/slab_pool.hh"
 #include "util/typedef.hh"
 #include "util/types.hh"
 
@@ -23,15 +23,22 @@ class Repairer
   Repairer(const Count &id, const Count &total,
            const Path &load_path, const Path &store_path,
            const Count &block_num, const DataSize &size,
-           const Path &bandwidth_path, const Name &eth_name,
-           const bool &if_print, const Count &recv_thr_num,
-           const Count &comp_thr_num, const Count &proc_thr_num);
+           const DataSize &slice_size, const Path &bandwidth_path,
+           const Name &eth_name, const bool &if_print,
+           const Count &recv_thr_num,
+           const Count &comp_thr_num, const Count &proc_thr_num,
+           const Count &poll_thr_num = 0,
+           const AccessOptions &options = AccessOptions(),
+           const MemoryOptions &mem_options = MemoryOptions(),
+           const ThreadOptions &threads = ThreadOptions());
   ~Repairer();
 
   //Connect to other nodes and prepare for repairing
   void Prepare(const IPAddressList &ip_addresses);
   //Wait Master to send close signal and wait for the repairer to be closed
   void WaitForFinish();
+  //Print the traffic of the connections and the slices used
+  void ShowStats();
 
   //Repairer is neither copyable nor movable
   Repairer(const Repairer&) = delete;
@@ -39,19 +46,26 @@ class Repairer
 
  private:
   Count id_;
+  Count total_;
   AccessCenter ac_;
-  MemoryPool mp_;
+  SlabPool sp_;   //block_num * size bytes in slices of slice_size
   ProceedProcessor proceeder_;
   ComputeProcessor computer_;
   ReceiveProcessor receiver_;
 
+  ThreadOptions threads_; //Where the threads of each stage run
+
   BandwidthSolver bs_;
   Path bandwidth_path_;
+  bool token_bucket_; //Limit the bandwidth by ac_ instead of bs_
 
   bool on_run_;
   std::mutex mtx_;
-  std::thread task_getter_;
-  void GetTaks();
+  std::condition_variable cv_;
+
+  //Handlers of the messages from the master
+  void OnTask_(const ControlChannel::Message &msg);
+  void OnBandwidth_(const ControlChannel::Message &msg);
 };
 
 } // namespace exr
@@ -1,3 +1,5 @@
+#include <cstring>
+#include <initializer_list>
 #include <iostream>
 #include <memory>
 #include <mutex>
@@ -31,17 +33,17 @@ int main()
   const exr::DataSize bsize = 67108864;
   exr::Repairer nr[total - 1] = {
     {1, total, dpath + pathr, dpath + "1" + pathw, total, bsize,
-     bw_path, eth_name, true, 6, 3, 10},
+     bsize / 4, bw_path, eth_name, true, 6, 3, 10},
     {2, total, dpath + pathr, dpath + "2" + pathw, total, bsize,
-     bw_path, eth_name, true, 6, 3, 10},
+     bsize / 4, bw_path, eth_name, true, 6, 3, 10},
     {3, total, dpath + pathr, dpath + "3" + pathw, total, bsize,
-     bw_path, eth_name, true, 6, 3, 10},
+     bsize / 4, bw_path, eth_name, true, 6, 3, 10},
     {4, total, dpath + pathr, dpath + "4" + pathw, total, bsize,
-     bw_path, eth_name, true, 6, 3, 10},
+     bsize / 4, bw_path, eth_name, true, 6, 3, 10},
     {5, total, dpath + pathr, dpath + "5" + pathw, total, bsize,
-     bw_path, eth_name, true, 6, 3, 10},
+     bsize / 4, bw_path, eth_name, true, 6, 3, 10},
     {6, total, dpath + pathr, dpath + "6" + pathw, total, bsize,
-     bw_path, eth_name, true, 6, 3, 10}};
+     bsize / 4, bw_path, eth_name, true, 6, 3, 10}};
   exr::AccessCenter ac(0, total);
 
   //Connect
@@ -53,59 +55,66 @@ int main()
     t[i].join();
   std::cout << "Connected and has prepared for repairing..." << std::endl;
 
+  //Tasks are sent with the ids of their sources on the control connections
+  auto send_task = [&](const exr::Count &node, const exr::RepairTask &rt,
+                       std::initializer_list<exr::Count> srcs) {
+    exr::ControlChannel::Message msg(sizeof(rt) + srcs.size() *
+                                     sizeof(exr::Count));
+    memcpy(msg.data(), &rt, sizeof(rt));
+    memcpy(msg.data() + sizeof(rt), srcs.begin(),
+           srcs.size() * sizeof(exr::Count));
+    ac.Control(node).Post(exr::ControlType::kTask, msg.data(), msg.size());
+  };
+  auto wait_done = [&](const exr::Count &node) {
+    exr::ControlChannel::Message msg;
+    ac.Control(node).Take(exr::ControlType::kDone, msg);
+    return *reinterpret_cast<exr::Count*>(msg.data());
+  };
+
   exr::Count c1 = 1, c2 = 2, c3 = 3, c4 = 4, c5 = 5;
   exr::Count r = 0;
   exr::BwType bandwidth = 1000000;
   //Test #1 piece 100
   exr::RepairTask task{1, 0, 2, 0, 1024, 1024, 1, bandwidth};
-  ac.Send(1, sizeof(task), &task);
+  send_task(1, task, {});
 
   task.src_num = 1;
   task.tar_id = 3;
-  ac.Send(2, sizeof(task), &task);
-  ac.Send(2, sizeof(c1), &(c1));
-
-  ac.Send(3, sizeof(task), &task);
-  ac.Send(3, sizeof(c2), &(c2));
+  send_task(2, task, {c1});
+  send_task(3, task, {c2});
 
-  ac.Receive(3, sizeof(r), &r);
+  r = wait_done(3);
   std::cout << "node 1, 2, 3 compeleted task " << r << std::endl;
 
   //Test #2 & #3 piece 10
   std::cout << "start task2 and task3 simultaneously" << std::endl;
   exr::RepairTask task2{2, 0, 2, 0, 1024, 1024, 1, bandwidth};
-  ac.Send(1, sizeof(task2), &task2);
-  ac.Send(3, sizeof(task2), &task2);
+  send_task(1, task2, {});
+  send_task(3, task2, {});
 
   exr::RepairTask task3{3, 1, 1, 0, 1024, 1024, 1, bandwidth};
-  ac.Send(2, sizeof(task3), &task3);
-  ac.Send(2, sizeof(c3), &(c3));
+  send_task(2, task3, {c3});
 
   task3.src_num = 0;
   task3.tar_id = 2;
-  ac.Send(3, sizeof(task3), &task3);
+  send_task(3, task3, {});
 
   task2.src_num = 2;
-  ac.Send(2, sizeof(task2), &task2);
-  ac.Send(2, sizeof(c3), &(c3));
-  ac.Send(2, sizeof(c1), &(c1));
+  send_task(2, task2, {c3, c1});
 
   task3.src_num = 1;
   task3.tar_id = 1;
-  ac.Send(1, sizeof(task3), &task3);
-  ac.Send(1, sizeof(c2), &(c2));
+  send_task(1, task3, {c2});
 
   std::mutex mtx;
   t[0] = std::thread([&] {
-    exr::Count k;
-    ac.Receive(1, sizeof(k), &k);
+    exr::Count k = wait_done(1);
     std::unique_lock<std::mutex> lck(mtx);
     std::cout << "node 1, 2, 3 compeleted task " << k << std::endl;
     lck.unlock();
   });
   t[1] = std::thread([&] {
-    exr::Count k;
-    ac.Receive(2, sizeof(k), &k);
+    exr::Count k = wait_done(2);
     std::unique_lock<std::mutex> lck(mtx);
     std::cout << "node 1, 2, 3 compeleted task " << k << std::endl;
     lck.unlock();
@@ -117,32 +126,43 @@ int main()
   std::cout << "start task4" << std::endl;
   exr::DataSize size = 67108864, psize = 67108864 / 4;
   auto task4 = exr::RepairTask{4, 0, 3, 0, size, psize, 1, bandwidth};
-  ac.Send(2, sizeof(task4), &task4);
+  send_task(2, task4, {});
 
   task4.tar_id = 4;
   task4.src_num = 1;
-  ac.Send(3, sizeof(task4), &task4);
-  ac.Send(3, sizeof(c2), &(c2));
+  send_task(3, task4, {c2});
 
   task4.tar_id = 5;
-  ac.Send(4, sizeof(task4), &task4);
-  ac.Send(4, sizeof(c3), &(c3));
+  send_task(4, task4, {c3});
 
   task4.tar_id = 1;
-  ac.Send(5, sizeof(task4), &task4);
-  ac.Send(5, sizeof(c4), &(c4));
-
-  ac.Send(1, sizeof(task4), &task4);
-  ac.Send(1, sizeof(c5), &(c5));
+  send_task(5, task4, {c4});
+  send_task(1, task4, {c5});
 
-  ac.Receive(1, sizeof(r), &r);
+  r = wait_done(1);
   std::cout << "node 2, 3, 4, 5, 1 compeleted task " << r << std::endl;
 
+  //Test #5 two lost blocks, all the nodes read the same file: lane 0 is
+  //    d + d = 0, lane 1 is 2d + 3d = d
+  std::cout << "start task5 with two lanes" << std::endl;
+  auto task5 = exr::RepairTask{5, 0, 6, 0, 4194304, 1048576, 1, bandwidth};
+  task5.lane_num = 2;
+  task5.lane_coefs[0] = 2;
+  send_task(4, task5, {});
+  task5.lane_coefs[0] = 3;
+  send_task(5, task5, {});
+
+  task5.tar_id = 6;
+  task5.src_num = 2;
+  send_task(6, task5, {c4, c5});
+
+  r = wait_done(6);
+  std::cout << "node 4, 5, 6 compeleted task " << r << std::endl;
+
   //Close
-  _ = system(("rm " + dpath + "*.txt").c_str());
-  exr::RepairTask end_task{0, 0, 0, 0, 0, 0, 0};
+  _ = system(("rm " + dpath + "*.txt*").c_str());
   for (int i = 1; i < total; ++i) {
-    ac.Send(i, sizeof(end_task), &end_task);
+    ac.Control(i).Post(exr::ControlType::kShutdown);
     nr[i - 1].WaitForFinish();
   }
   std::cout << "Closed, test ended" << std::endl;
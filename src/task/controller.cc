@@ -1,7 +1,12 @@
 #include "task/controller.hh"
 
 #include <sys/time.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 #include <thread>
+#include <vector>
 
 #include "task/algorithm/ftp_repair.hh"
 #include "task/algorithm/ppr.hh"
@@ -11,9 +16,13 @@
 namespace exr {
 
 Controller::Controller(const Count &total,
-                       const DataSize &size, const DataSize &psize)
+                       const DataSize &size, const DataSize &psize,
+                       const Count &task_cap, const Count &lane_num)
     : size_(size), psize_(psize), ac_(0, total), ptg_(nullptr),
-      cur_tid_(0), gnum_(0), task_num_(0) {
+      coefs_(nullptr), lane_num_(std::min<Count>(lane_num, kMaxLanes)),
+      node_coefs_(total * kMaxLanes, 1), cur_tid_(0), gnum_(0),
+      task_num_(0), task_cap_(task_cap), loads_(total, 0), running_(0),
+      max_running_(0) {
   src_lists_ = std::make_unique<std::unique_ptr<Count[]>[]>(total - 1);
   for (Count i = 0; i < total - 1; ++i)
     src_lists_[i] = std::make_unique<Count[]>(total - 2);
@@ -21,12 +30,24 @@ Controller::Controller(const Count &total,
 
 Controller::~Controller() = default;
 
+//The requestors report the tasks stored
 void Controller::Connect(const IPAddressList &ip_addresses) {
   ac_.Connect(ip_addresses);
+  for (Count i = 1; i < loads_.size(); ++i)
+    ac_.Control(i).On(ControlType::kDone,
+                      [&](const ControlChannel::Message &msg) {
+      OnDone_(msg);
+    });
 }
 
+//The tasks loaded are not of a known code, their coefficients are 1
 void Controller::ChangeAlg(const Alg &alg, const Count *args,
                            const Path &path) {
+  coefs_.reset();
+  if (alg != 't' && args) {
+    coefs_ = std::make_unique<CoefCache>(args[1], args[0], kCoefCacheSize);
+    coefs_->Precompute();
+  }
   if (alg == 't') {
     ptg_ = pTaskGetter(new TaskReader(path));
   } else if (alg == 'j') {
@@ -44,80 +65,196 @@ bool Controller::GetTasks() {
   if (gnum_ == kMaxGroupNum) {
     return false;
   }
+  SetCoefs_();
   return true;
 }
 
 BwType Controller::GetCapacity() { return ptg_->get_capacity(); }
 
 Count Controller::DoTaskGroups(const Count &total) {
-  Count max_task_num = 0;
+  max_running_ = 0;
   auto t = std::make_unique<std::thread[]>(total - 1);
   for (Count i = 0; i < gnum_; ++i) {
     task_num_ = ptg_->GetTaskNumber(i);
-    //Send tasks of one group
-    for (Count j = 1; j < total; ++j)
-      t[j-1] = std::thread([&, i, j] { DeliverTasks_(i, j); });
-    for (Count j = 0; j < total - 1; ++j) t[j].join();
-    //Wait for finishing
-    if (task_num_ > max_task_num) max_task_num = task_num_;
-    WaitForFinish_();
+    if (task_cap_ > 0) {
+      //Start the tasks when their nodes are free
+      for (Count j = 0; j < task_num_; ++j) StartTask_(i, j, total);
+    } else {
+      //Send tasks of one group and wait for finishing
+      for (Count j = 1; j < total; ++j)
+        t[j-1] = std::thread([&, i, j] { DeliverTasks_(i, j); });
+      for (Count j = 0; j < total - 1; ++j) t[j].join();
+      WaitForFinish_();
+    }
+    cur_tid_ += task_num_;
   }
-  return max_task_num;
+  WaitForFinish_();
+  return max_running_;
 }
 
 void Controller::Close(const Count &total) {
-  RepairTask end_task{0, 0, 0, 0, 0, 0, 0, 0};
   for (Count i = 1; i < total; ++i)
-    ac_.Send(i, sizeof(end_task), &end_task);
+    ac_.Control(i).Post(ControlType::kShutdown);
 }
 
 void Controller::ReloadNodeBandwidth(const Count &total) {
-  RepairTask reload_info{0, 0, 0, 1, 0, 1, 0, 0};
   for (Count i = 1; i < total; ++i)
-    ac_.Send(i, sizeof(reload_info), &reload_info);
-  Count r;
-  for (Count i = 1; i < total; ++i) ac_.Receive(i, sizeof(r), &r);
+    ac_.Control(i).Post(ControlType::kReload);
+  WaitForAcks_(total);
 }
 
+//The requestor's bandwidth is full
 void Controller::SetNewNodeBandwidth(const Count &total) {
-  RepairTask set_new_info{0, 0, 0, 0, 0, 1, 0, 1};
   for (Count i = 1; i < total; ++i) {
-    if (i == ptg_->GetRid()) set_new_info.bandwidth = 0;
-    ac_.Send(i, sizeof(set_new_info), &set_new_info);
-    set_new_info.bandwidth = 1;
+    bool is_full = (i == ptg_->GetRid());
+    ac_.Control(i).Post(ControlType::kBandwidth, &is_full, sizeof(is_full));
+  }
+  WaitForAcks_(total);
+}
+
+//Print the traffic of the nodes and the latency of the control messages
+void Controller::ShowNodeStats(const Count &total) {
+  ControlChannel::Message msg;
+  for (Count i = 1; i < total; ++i) {
+    auto rtt = ac_.Control(i).Ping();
+    ac_.Control(i).Post(ControlType::kStats);
+    if (!ac_.Control(i).Take(ControlType::kStats, msg)) continue;
+    auto traffic = reinterpret_cast<Traffic*>(msg.data());
+    std::cout << "node " << i << ": sent " << traffic->sent / 1e6
+              << " MB, received " << traffic->received / 1e6
+              << " MB, control round trip " << rtt << " us" << std::endl;
   }
-  Count r;
-  for (Count i = 1; i < total; ++i) ac_.Receive(i, sizeof(r), &r);
 }
 
+//A task is added before it is sent, so that it is done after added
 void Controller::DeliverTasks_(const Count &gid, const Count &nid){
+  ControlChannel::Message msg;
+  for (Count j = 0; j < task_num_; ++j) {
+    if (!FillTask_(gid, j, nid, msg)) continue;
+    auto rt = reinterpret_cast<RepairTask*>(msg.data());
+    AddNode_(rt->task_id, nid, rt->tar_id == nid);
+    ac_.Control(nid).Post(ControlType::kTask, msg.data(), msg.size());
+  }
+}
+
+//Wait until all the nodes in the task are under the cap, then send
+void Controller::StartTask_(const Count &gid, const Count &idx,
+                            const Count &total) {
+  std::vector<Count> nids;
+  std::vector<ControlChannel::Message> msgs(total);
+  for (Count i = 1; i < total; ++i)
+    if (FillTask_(gid, idx, i, msgs[i])) nids.push_back(i);
+  if (nids.empty()) return;
+
+  std::unique_lock<std::mutex> lck(mtx_);
+  cv_.wait(lck, [&] {
+    for (auto nid : nids)
+      if (loads_[nid] >= task_cap_) return false;
+    return true;
+  });
+  lck.unlock();
+  for (auto nid : nids) {
+    auto rt = reinterpret_cast<RepairTask*>(msgs[nid].data());
+    AddNode_(rt->task_id, nid, rt->tar_id == nid);
+  }
+  for (auto nid : nids)
+    ac_.Control(nid).Post(ControlType::kTask, msgs[nid].data(),
+                          msgs[nid].size());
+}
+
+//The task of a node with the ids of the sources,
+//    false if the node is not in the task
+bool Controller::FillTask_(const Count &gid, const Count &idx,
+                           const Count &nid, ControlChannel::Message &msg) {
   auto &srcs = src_lists_[nid - 1];
-  for (Count j = 0, tid = cur_tid_; j < task_num_; ++j, ++tid) {
-    //Get task's content
-    RepairTask rt{tid, 0, 0, 0, size_, psize_, 1, 0};
-    ptg_->FillTask(gid, j, nid, rt, srcs.get());
-
-    //Send to the node
-    if (rt.size > 0) {
-      ac_.Send(nid, sizeof(rt), &rt);
-      for (Count k = 0; k < rt.src_num; ++k)
-        ac_.Send(nid, sizeof(srcs[k]), &(srcs[k]));
-      if (rt.tar_id == nid) {
-        std::unique_lock<std::mutex> lck(mtx_);
-        waits_.push_back(nid);
-        lck.unlock();
+  RepairTask rt{static_cast<Count>(cur_tid_ + idx), 0, 0, 0, size_, psize_,
+                1, 0};
+  ptg_->FillTask(gid, idx, nid, rt, srcs.get());
+  if (rt.size <= 0) return false;
+  rt.lane_num = lane_num_;
+  rt.coef = node_coefs_[nid * kMaxLanes];
+  for (Count l = 1; l < lane_num_; ++l)
+    rt.lane_coefs[l - 1] = node_coefs_[nid * kMaxLanes + l];
+  msg.resize(sizeof(rt) + rt.src_num * sizeof(Count));
+  memcpy(msg.data(), &rt, sizeof(rt));
+  memcpy(msg.data() + sizeof(rt), srcs.get(), rt.src_num * sizeof(Count));
+  return true;
+}
+
+//The helpers are the nodes other than the requestor in any of the groups,
+//    a repair may take several groups. The lost blocks are the requestor's
+//    and those of the first nodes of the stripe left out of the repair
+void Controller::SetCoefs_() {
+  std::fill(node_coefs_.begin(), node_coefs_.end(), 1);
+  Count rid = ptg_->GetRid();
+  if (!coefs_ || rid == 0) return;
+
+  Count total = loads_.size();
+  std::vector<Count> srcs, losts{static_cast<Count>(rid - 1)};
+  std::vector<Count> ids(total);
+  for (Count i = 1; i < total; ++i) {
+    if (i == rid) continue;
+    bool helps = false;
+    for (Count gid = 0; gid < gnum_ && !helps; ++gid) {
+      for (Count idx = 0; idx < ptg_->GetTaskNumber(gid) && !helps; ++idx) {
+        RepairTask rt{0, 0, 0, 0, size_, psize_, 1, 0};
+        ptg_->FillTask(gid, idx, i, rt, ids.data());
+        helps = rt.size > 0;
       }
     }
+    if (helps)
+      srcs.push_back(i - 1);
+    else if (losts.size() < lane_num_ && i <= coefs_->get_n())
+      losts.push_back(i - 1);
+  }
+  if (rid > coefs_->get_n() || srcs.size() != coefs_->get_k() ||
+      srcs.back() >= coefs_->get_n() || losts.size() < lane_num_) {
+    std::cerr << "The helpers are not " << coefs_->get_k()
+              << " nodes of the stripe with " << lane_num_
+              << " blocks left out, their coefficients are 1" << std::endl;
+    return;
   }
+
+  auto k = srcs.size();
+  std::vector<RSUnit> results(lane_num_ * k);
+  coefs_->Decode(lane_num_, losts.data(), srcs.data(), results.data());
+  for (Count l = 0; l < lane_num_; ++l)
+    for (size_t j = 0; j < k; ++j)
+      node_coefs_[(srcs[j] + 1) * kMaxLanes + l] = results[l * k + j];
+}
+
+void Controller::AddNode_(const Count &tid, const Count &nid,
+                          const bool &is_tar) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  task_nodes_[tid].push_back(nid);
+  ++loads_[nid];
+  if (is_tar && ++running_ > max_running_) max_running_ = running_;
+}
+
+//The nodes in a stored task are freed
+void Controller::OnDone_(const ControlChannel::Message &msg) {
+  auto tid = *reinterpret_cast<const Count*>(msg.data());
+  std::unique_lock<std::mutex> lck(mtx_);
+  auto it = task_nodes_.find(tid);
+  if (it == task_nodes_.end()) return;
+  for (auto nid : it->second) --loads_[nid];
+  task_nodes_.erase(it);
+  --running_;
+  cv_.notify_all();
 }
 
 void Controller::WaitForFinish_() {
-  //Wait for finish
-  Count recv;
-  for (auto &x: waits_)
-    ac_.Receive(x, sizeof(recv), &recv);
-  cur_tid_ += task_num_;
-  waits_.clear();
+  std::unique_lock<std::mutex> lck(mtx_);
+  cv_.wait(lck, [&] { return running_ == 0; });
 }
 
+void Controller::WaitForAcks_(const Count &total) {
+  ControlChannel::Message msg;
+  for (Count i = 1; i < total; ++i)
+    ac_.Control(i).Take(ControlType::kAck, msg);
+}
+
+//Static values
+const size_t Controller::kCoefCacheSize = 4096;
+
 } // namespace exr
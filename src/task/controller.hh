@@ -1,22 +1,32 @@
 #ifndef EXR_TASK_CONTROLLER_HH_
 #define EXR_TASK_CONTROLLER_HH_
 
+#include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "data/access/access_center.hh"
 #include "task/task_getter_interface.hh"
+#include "util/coef_cache.hh"
 #include "util/typedef.hh"
 
 namespace exr {
 
-/* Control all the repair work like arranging routes and sending tasks */
+/* Control all the repair work like arranging routes and sending tasks.
+ * With a task cap, the tasks of all the groups are started one after
+ * another as soon as the nodes in them have fewer tasks than the cap,
+ * otherwise the groups are run one at a time. Each helper gets the decode
+ * coefficients of its block, node i holding block i - 1 of the stripe and
+ * the requestor the lost one. With more lanes, more lost blocks are
+ * repaired by the same helpers, each helper reading its block once */
 class Controller
 {
  public:
   Controller(const Count &total,
-             const DataSize &size, const DataSize &psize);
+             const DataSize &size, const DataSize &psize,
+             const Count &task_cap = 0, const Count &lane_num = 1);
   ~Controller();
 
   void Connect(const IPAddressList &ip_addresses);
@@ -24,11 +34,14 @@ class Controller
 
   bool GetTasks();
   BwType GetCapacity();
+  //Run all the groups, return the most tasks in flight at the same time
   Count DoTaskGroups(const Count &total);
   void Close(const Count &total);
 
   void ReloadNodeBandwidth(const Count &total);
   void SetNewNodeBandwidth(const Count &total);
+  //Ask each node for its traffic
+  void ShowNodeStats(const Count &total);
 
   //Controller is neither copyable nor movable
   Controller(const Controller&) = delete;
@@ -40,16 +53,35 @@ class Controller
   AccessCenter ac_;
   using pTaskGetter = std::unique_ptr<TaskGetterInterface>;
   pTaskGetter ptg_;
+  std::unique_ptr<CoefCache> coefs_; //nullptr if the code is unknown
+  Count lane_num_;                   //Lost blocks of each stripe
+  std::vector<RSUnit> node_coefs_;   //Of each node and lane, 1 for XOR
 
   Count cur_tid_;
   Count gnum_;
   Count task_num_;
   std::unique_ptr<std::unique_ptr<Count[]>[]> src_lists_;
-  std::vector<Count> waits_;
+
+  //Tasks in flight and the nodes in each of them
+  Count task_cap_;
+  std::vector<Count> loads_;
+  std::unordered_map<Count, std::vector<Count>> task_nodes_;
+  Count running_;
+  Count max_running_;
   std::mutex mtx_;
+  std::condition_variable cv_;
 
   void DeliverTasks_(const Count &gid, const Count &nid);
+  void StartTask_(const Count &gid, const Count &idx, const Count &total);
+  bool FillTask_(const Count &gid, const Count &idx, const Count &nid,
+                 ControlChannel::Message &msg);
+  void SetCoefs_();
+  void AddNode_(const Count &tid, const Count &nid, const bool &is_tar);
+  void OnDone_(const ControlChannel::Message &msg);
   void WaitForFinish_();
+  void WaitForAcks_(const Count &total);
+
+  static const size_t kCoefCacheSize; //Source sets of the coefficients
 };
 
 } // namespace exr
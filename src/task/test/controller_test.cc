@@ -1,4 +1,5 @@
 #include <array>
+#include <condition_variable>
 #include <iostream>
 #include <mutex>
 #include <thread>
@@ -36,36 +37,48 @@ int main()
 
   //Show tasks
   std::mutex mtx;
+  std::condition_variable cv;
+  exr::Count closed = 0;
   for (int i = 0; i < total - 1; ++i) {
-    t[i] = std::thread([&, i] {
-      exr::RepairTask rt;
-      exr::Count c;
-      while (true) {
-        ac[i].Receive(0, sizeof(rt), &rt);
-        if (rt.size == 0) break;
-        std::unique_lock<std::mutex> lck(mtx);
-        std::cout << std::endl
-                  << "node " << i + 1 << " receives: " << std::endl
-                  << "  task_id:   " << rt.task_id << std::endl
-                  << "  tar_id:    " << rt.tar_id << std::endl
-                  << "  offset:    " << rt.offset << std::endl
-                  << "  size:      " << rt.size << std::endl
-                  << "  psize:     " << rt.piece_size << std::endl
-                  << "  bandwidth: " << rt.bandwidth << std::endl
-                  << "  coef:      " << static_cast<int>(rt.coef)
-                  << std::endl << "  src_ids:   ";
-        for (exr::Count j = 0; j < rt.src_num; ++j) {
-          ac[i].Receive(0, sizeof(c), &c);
-          std::cout << c << " ";
-        }
-        std::cout << std::endl;
-        lck.unlock();
-        if (rt.tar_id == i + 1) {
-          std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-          ac[i].Send(0, sizeof(c), &c);
-        }
+    auto &master = ac[i].Control(0);
+    master.On(exr::ControlType::kTask,
+              [&, i](const exr::ControlChannel::Message &msg) {
+      auto rt = reinterpret_cast<const exr::RepairTask*>(msg.data());
+      auto srcs = reinterpret_cast<const exr::Count*>(msg.data() +
+                                                      sizeof(*rt));
+      std::unique_lock<std::mutex> lck(mtx);
+      std::cout << std::endl
+                << "node " << i + 1 << " receives: " << std::endl
+                << "  task_id:   " << rt->task_id << std::endl
+                << "  tar_id:    " << rt->tar_id << std::endl
+                << "  offset:    " << rt->offset << std::endl
+                << "  size:      " << rt->size << std::endl
+                << "  psize:     " << rt->piece_size << std::endl
+                << "  bandwidth: " << rt->bandwidth << std::endl
+                << "  coef:      " << static_cast<int>(rt->coef)
+                << std::endl << "  src_ids:   ";
+      for (exr::Count j = 0; j < rt->src_num; ++j)
+        std::cout << srcs[j] << " ";
+      std::cout << std::endl;
+      lck.unlock();
+      if (rt->tar_id == i + 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        ac[i].Control(0).Post(exr::ControlType::kDone, &(rt->task_id),
+                              sizeof(rt->task_id));
       }
     });
+    master.On(exr::ControlType::kStats,
+              [&, i](const exr::ControlChannel::Message &msg) {
+      auto traffic = ac[i].GetTraffic();
+      ac[i].Control(0).Post(exr::ControlType::kStats, &traffic,
+                            sizeof(traffic));
+    });
+    master.On(exr::ControlType::kShutdown,
+              [&](const exr::ControlChannel::Message &msg) {
+      std::unique_lock<std::mutex> lck(mtx);
+      ++closed;
+      cv.notify_all();
+    });
   }
 
   //Run task reader
@@ -96,8 +109,10 @@ int main()
   }
 
   //Close
+  con.ShowNodeStats(total);
   con.Close(total);
-  for (int i = 0; i < total - 1; ++i) t[i].join();
+  std::unique_lock<std::mutex> lck(mtx);
+  cv.wait(lck, [&] { return closed == total - 1; });
   std::cout << std::endl << "All threads closed, test ended." << std::endl;
   return 0;
 }
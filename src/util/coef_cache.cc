@@ -0,0 +1,101 @@
+#include "util/coef_cache.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace exr {
+
+//Constructor and destructor
+CoefCache::CoefCache(const Count &n, const Count &k, const size_t &capacity)
+    : n_(n), k_(k), capacity_(std::max<size_t>(capacity, 1)), rc_(n, k),
+      inv_(std::make_unique<RSUnit[]>(k * k)), hits_(0), misses_(0) {
+  rc_.InitForDecode();
+}
+
+CoefCache::~CoefCache() = default;
+
+//The coefs are kept in the order of the sorted sources, and given back in
+//    the order of srcs
+void CoefCache::Decode(const Count &tar_n, const Count *tars,
+                       const Count *srcs, RSUnit *results) {
+  std::vector<Count> sorted(srcs, srcs + k_);
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<Count> pos(k_);
+  for (Count j = 0; j < k_; ++j)
+    pos[j] = std::lower_bound(sorted.begin(), sorted.end(), srcs[j]) -
+             sorted.begin();
+
+  std::lock_guard<std::mutex> lck(mtx_);
+  auto &entry = Find_(sorted);
+  for (Count i = 0; i < tar_n; ++i) {
+    auto coefs = entry.coefs.get() + tars[i] * k_;
+    for (Count j = 0; j < k_; ++j)
+      results[i * k_ + j] = coefs[pos[j]];
+  }
+}
+
+size_t CoefCache::Precompute() {
+  std::lock_guard<std::mutex> lck(mtx_);
+  std::vector<bool> chosen(n_, false);
+  std::fill(chosen.begin(), chosen.begin() + k_, true);
+  std::vector<Count> srcs(k_);
+  do {
+    if (lru_.size() >= capacity_) break;
+    for (Count i = 0, j = 0; i < n_; ++i)
+      if (chosen[i]) srcs[j++] = i;
+    if (index_.find(srcs) == index_.end()) Insert_(srcs);
+  } while (std::prev_permutation(chosen.begin(), chosen.end()));
+  return lru_.size();
+}
+
+Count CoefCache::get_n() { return n_; }
+Count CoefCache::get_k() { return k_; }
+size_t CoefCache::get_capacity() { return capacity_; }
+
+size_t CoefCache::get_size() {
+  std::lock_guard<std::mutex> lck(mtx_);
+  return lru_.size();
+}
+
+uint64_t CoefCache::get_hits() {
+  std::lock_guard<std::mutex> lck(mtx_);
+  return hits_;
+}
+
+uint64_t CoefCache::get_misses() {
+  std::lock_guard<std::mutex> lck(mtx_);
+  return misses_;
+}
+
+CoefCache::Entry& CoefCache::Find_(const std::vector<Count> &srcs) {
+  auto it = index_.find(srcs);
+  if (it != index_.end()) {
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return lru_.front();
+  }
+  ++misses_;
+  Insert_(srcs);
+  return lru_.front();
+}
+
+void CoefCache::Insert_(const std::vector<Count> &srcs) {
+  if (lru_.size() >= capacity_) {
+    index_.erase(lru_.back().srcs);
+    lru_.pop_back();
+  }
+  Entry entry;
+  entry.srcs = srcs;
+  entry.coefs = std::make_unique<RSUnit[]>(n_ * k_);
+  if (!rc_.Invert(srcs.data(), inv_.get())) {
+    std::cerr << "error when inverting matrix" << std::endl;
+    exit(-1);
+  }
+  for (Count t = 0; t < n_; ++t)
+    rc_.Combine(inv_.get(), t, entry.coefs.get() + t * k_);
+  lru_.push_front(std::move(entry));
+  index_[srcs] = lru_.begin();
+}
+
+} // namespace exr
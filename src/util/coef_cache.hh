@@ -0,0 +1,71 @@
+#ifndef EXR_UTIL_COEFCACHE_HH_
+#define EXR_UTIL_COEFCACHE_HH_
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "util/rs_computer.hh"
+#include "util/typedef.hh"
+
+namespace exr {
+
+/* The decode coefficients of the recent source sets of an (n, k) code. A
+ * source set is kept with its inverted matrix and the coefficients of all
+ * the n nodes on it, so any targets repaired from the same sources later
+ * only need a lookup. The least recently used set is dropped when full */
+class CoefCache
+{
+ public:
+  CoefCache(const Count &n, const Count &k, const size_t &capacity);
+  ~CoefCache();
+
+  //The same as RSComputer::Decode, srcs in any order
+  void Decode(const Count &tar_n, const Count *tars, const Count *srcs,
+              RSUnit *results);
+  //Cache every set of k sources, which covers all the failure patterns,
+  //    stop when the cache is full; returns the sets cached
+  size_t Precompute();
+
+  Count get_n();
+  Count get_k();
+  size_t get_capacity();
+  size_t get_size();
+  uint64_t get_hits();
+  uint64_t get_misses();
+
+  //CoefCache is neither copyable nor movable
+  CoefCache(const CoefCache&) = delete;
+  CoefCache& operator=(const CoefCache&) = delete;
+
+ private:
+  struct Entry {
+    std::vector<Count> srcs;         //Sorted
+    std::unique_ptr<RSUnit[]> coefs; //n * k, of each node on the sources,
+                                     //    the first k rows are the inverse
+  };
+  using Lru = std::list<Entry>;
+
+  Count n_;
+  Count k_;
+  size_t capacity_;
+  RSComputer rc_;
+  std::unique_ptr<RSUnit[]> inv_; //k * k, for inverting
+
+  Lru lru_; //The most recently used first
+  std::map<std::vector<Count>, Lru::iterator> index_;
+  uint64_t hits_;
+  uint64_t misses_;
+  std::mutex mtx_;
+
+  //The entry of the sorted sources, the matrix is inverted if not cached
+  Entry& Find_(const std::vector<Count> &srcs);
+  void Insert_(const std::vector<Count> &srcs);
+};
+
+} // namespace exr
+
+#endif // EXR_UTIL_COEFCACHE_HH_
@@ -0,0 +1,105 @@
+#include "util/compressor.hh"
+
+#include <iostream>
+#include <memory>
+
+#ifdef EXR_WITH_LZ4
+#include <lz4.h>
+#endif
+#ifdef EXR_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace exr {
+
+#ifdef EXR_WITH_ZSTD
+namespace {
+
+//Contexts are reused by each thread
+ZSTD_CCtx* CCtx() {
+  static thread_local std::unique_ptr<ZSTD_CCtx, size_t(*)(ZSTD_CCtx*)>
+      ctx(ZSTD_createCCtx(), ZSTD_freeCCtx);
+  return ctx.get();
+}
+
+ZSTD_DCtx* DCtx() {
+  static thread_local std::unique_ptr<ZSTD_DCtx, size_t(*)(ZSTD_DCtx*)>
+      ctx(ZSTD_createDCtx(), ZSTD_freeDCtx);
+  return ctx.get();
+}
+
+} // namespace
+#endif
+
+//Constructor, a codec not built in is replaced by kNone
+Compressor::Compressor(const Count &codec, const int &level)
+    : codec_(codec), level_(level) {
+  if (codec_ != kNone && !(SupportedCodecs() & (1 << codec_))) {
+    std::cerr << "Codec " << codec_ << " is not built in, "
+              << "pieces are sent without compression" << std::endl;
+    codec_ = kNone;
+  }
+}
+
+DataSize Compressor::Bound(const DataSize &size) {
+#ifdef EXR_WITH_LZ4
+  if (codec_ == kLZ4) return LZ4_compressBound(size);
+#endif
+#ifdef EXR_WITH_ZSTD
+  if (codec_ == kZstd) return ZSTD_compressBound(size);
+#endif
+  return size;
+}
+
+DataSize Compressor::Compress(const BufUnit *src, const DataSize &size,
+                              BufUnit *dst) {
+#ifdef EXR_WITH_LZ4
+  //The level is the acceleration of LZ4, bigger for faster
+  if (codec_ == kLZ4)
+    return LZ4_compress_fast(src, dst, size, Bound(size),
+                             level_ > 0 ? level_ : 1);
+#endif
+#ifdef EXR_WITH_ZSTD
+  if (codec_ == kZstd) {
+    auto res = ZSTD_compressCCtx(CCtx(), dst, Bound(size), src, size,
+                                 level_);
+    return ZSTD_isError(res) ? 0 : res;
+  }
+#endif
+  return 0;
+}
+
+bool Compressor::Decompress(const BufUnit *src, const DataSize &csize,
+                            BufUnit *dst, const DataSize &size) {
+#ifdef EXR_WITH_LZ4
+  if (codec_ == kLZ4)
+    return LZ4_decompress_safe(src, dst, csize, size) == size;
+#endif
+#ifdef EXR_WITH_ZSTD
+  if (codec_ == kZstd) {
+    auto res = ZSTD_decompressDCtx(DCtx(), dst, size, src, csize);
+    return !ZSTD_isError(res) && static_cast<DataSize>(res) == size;
+  }
+#endif
+  return false;
+}
+
+Count Compressor::get_codec() { return codec_; }
+
+uint8_t Compressor::SupportedCodecs() {
+  uint8_t codecs = 1 << kNone;
+#ifdef EXR_WITH_LZ4
+  codecs |= 1 << kLZ4;
+#endif
+#ifdef EXR_WITH_ZSTD
+  codecs |= 1 << kZstd;
+#endif
+  return codecs;
+}
+
+//Static values
+const Count Compressor::kNone = 0;
+const Count Compressor::kLZ4 = 1;
+const Count Compressor::kZstd = 2;
+
+} // namespace exr
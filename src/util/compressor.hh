@@ -0,0 +1,46 @@
+#ifndef EXR_UTIL_COMPRESSOR_HH_
+#define EXR_UTIL_COMPRESSOR_HH_
+
+#include <cstdint>
+
+#include "util/typedef.hh"
+
+namespace exr {
+
+/* Compress pieces by one of the codecs built in, the codecs are enabled by
+ * making with WITH_LZ4=1 or WITH_ZSTD=1 */
+class Compressor
+{
+ public:
+  Compressor(const Count &codec, const int &level);
+  ~Compressor() = default;
+
+  //Size of the buffer that can hold the compressed data
+  DataSize Bound(const DataSize &size);
+  //Return the compressed size, 0 if failed
+  DataSize Compress(const BufUnit *src, const DataSize &size, BufUnit *dst);
+  //Decompress exactly size bytes, return false if the data is broken
+  bool Decompress(const BufUnit *src, const DataSize &csize,
+                  BufUnit *dst, const DataSize &size);
+
+  Count get_codec();
+
+  //Codecs of this build, bit (1 << codec) for each
+  static uint8_t SupportedCodecs();
+
+  //Compressor is neither copyable nor movable
+  Compressor(const Compressor&) = delete;
+  Compressor& operator=(const Compressor&) = delete;
+
+  static const Count kNone;
+  static const Count kLZ4;
+  static const Count kZstd;
+
+ private:
+  Count codec_;
+  int level_;
+};
+
+} // namespace exr
+
+#endif // EXR_UTIL_COMPRESSOR_HH_
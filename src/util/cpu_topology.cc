@@ -0,0 +1,168 @@
+#include "util/cpu_topology.hh"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "util/memory_pool.hh"
+
+namespace exr {
+
+//Constructor and destructor
+CpuTopology::CpuTopology(const Name &eth_name)
+    : eth_(eth_name),
+      core_num_(std::max<unsigned>(std::thread::hardware_concurrency(), 1)),
+      nic_node_(MemoryPool::NicNode(eth_name)) {
+  if (nic_node_ >= 0) {
+    std::ifstream f("/sys/devices/system/node/node" +
+                    std::to_string(nic_node_) + "/cpulist");
+    std::string list;
+    if (f >> list) nic_cores_ = ParseList_(list);
+  }
+  LoadIrqCores_();
+}
+
+CpuTopology::~CpuTopology() = default;
+
+//All the cores if the node of the interface is unknown
+std::vector<int> CpuTopology::ParseCores(const std::string &spec) {
+  if (spec == "-") return {};
+  if (spec != "nic") return ParseList_(spec);
+  if (!nic_cores_.empty()) return nic_cores_;
+  std::cerr << "NUMA node of " << eth_ << " unknown, use any core"
+            << std::endl;
+  return {};
+}
+
+void CpuTopology::AvoidIrqs(std::vector<int> &cores) {
+  std::vector<int> left;
+  if (cores.empty()) {
+    for (int c = 0; c < core_num_; ++c) left.push_back(c);
+  } else {
+    left = cores;
+  }
+  left.erase(std::remove_if(left.begin(), left.end(), [&](int c) {
+    return std::find(irq_cores_.begin(), irq_cores_.end(), c) !=
+           irq_cores_.end();
+  }), left.end());
+  if (!left.empty()) cores = left;
+}
+
+void CpuTopology::Show(const ThreadOptions &options) {
+  std::cout << core_num_ << " cores, " << eth_ << " on NUMA node ";
+  if (nic_node_ >= 0)
+    std::cout << nic_node_ << " (cores " << ListCores(nic_cores_) << ")";
+  else
+    std::cout << "unknown";
+  std::cout << ", interrupts on cores " << ListCores(irq_cores_)
+            << std::endl;
+  for (auto role : {&options.recv, &options.comp, &options.proc}) {
+    std::cout << "  " << role->name << " threads on cores "
+              << ListCores(role->cores)
+              << (role->isolate && !role->cores.empty() ? ", one each" : "")
+              << std::endl;
+  }
+}
+
+Count CpuTopology::get_core_num() { return core_num_; }
+int CpuTopology::get_nic_node() { return nic_node_; }
+const std::vector<int>& CpuTopology::get_irq_cores() { return irq_cores_; }
+
+//The thread keeps running where it is if the cores can't be set
+void CpuTopology::Place(const ThreadRole &role, const Count &i) {
+  if (!role.name.empty()) {
+    auto name = role.name + "-" + std::to_string(i);
+    name.resize(std::min(name.size(), kMaxNameLen));
+    pthread_setname_np(pthread_self(), name.c_str());
+  }
+  if (role.cores.empty()) return;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (role.isolate) {
+    CPU_SET(role.cores[i % role.cores.size()], &set);
+  } else {
+    for (auto c : role.cores) CPU_SET(c, &set);
+  }
+  auto err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (err != 0)
+    std::cerr << "Cannot pin " << role.name << " threads to cores "
+              << ListCores(role.cores) << ": " << strerror(err)
+              << std::endl;
+}
+
+std::string CpuTopology::ListCores(const std::vector<int> &cores) {
+  if (cores.empty()) return "any";
+  std::ostringstream ost;
+  for (size_t i = 0; i < cores.size();) {
+    auto j = i;
+    while (j + 1 < cores.size() && cores[j + 1] == cores[j] + 1) ++j;
+    if (i > 0) ost << ",";
+    ost << cores[i];
+    if (j > i) ost << "-" << cores[j];
+    i = j + 1;
+  }
+  return ost.str();
+}
+
+std::vector<int> CpuTopology::ParseList_(const std::string &list) {
+  std::vector<int> cores;
+  std::istringstream ist(list);
+  std::string range;
+  while (std::getline(ist, range, ',')) {
+    int first = -1, last = -1;
+    auto dash = range.find('-');
+    if (sscanf(range.c_str(), "%d", &first) != 1 ||
+        (dash != std::string::npos &&
+         sscanf(range.c_str() + dash + 1, "%d", &last) != 1)) {
+      std::cerr << "Bad core list: " << list << std::endl;
+      exit(-1);
+    }
+    if (dash == std::string::npos) last = first;
+    for (int c = first; c <= last; ++c) {
+      if (c >= 0 && c < core_num_)
+        cores.push_back(c);
+      else
+        std::cerr << "No core " << c << ", skipped" << std::endl;
+    }
+  }
+  std::sort(cores.begin(), cores.end());
+  cores.erase(std::unique(cores.begin(), cores.end()), cores.end());
+  return cores;
+}
+
+//The interrupts of the interface are its MSI vectors, the cores they are
+//    really delivered to are preferred over the ones allowed
+void CpuTopology::LoadIrqCores_() {
+  auto dir = opendir(("/sys/class/net/" + eth_ +
+                      "/device/msi_irqs").c_str());
+  if (!dir) return;
+  while (auto ent = readdir(dir)) {
+    if (ent->d_name[0] == '.') continue;
+    Path irq = "/proc/irq/" + std::string(ent->d_name) + "/";
+    std::ifstream f(irq + "effective_affinity_list");
+    std::string list;
+    if (!(f >> list)) {
+      std::ifstream g(irq + "smp_affinity_list");
+      if (!(g >> list)) continue;
+    }
+    for (auto c : ParseList_(list)) irq_cores_.push_back(c);
+  }
+  closedir(dir);
+  std::sort(irq_cores_.begin(), irq_cores_.end());
+  irq_cores_.erase(std::unique(irq_cores_.begin(), irq_cores_.end()),
+                   irq_cores_.end());
+}
+
+//Static values
+const size_t CpuTopology::kMaxNameLen = 15;
+
+} // namespace exr
@@ -0,0 +1,58 @@
+#ifndef EXR_UTIL_CPUTOPOLOGY_HH_
+#define EXR_UTIL_CPUTOPOLOGY_HH_
+
+#include <string>
+#include <vector>
+
+#include "util/typedef.hh"
+
+namespace exr {
+
+/* The cores of this host and where the network interface sits, used to
+ * choose the cores of the threads of each stage */
+class CpuTopology
+{
+ public:
+  explicit CpuTopology(const Name &eth_name);
+  ~CpuTopology();
+
+  //"0-3,8" for the cores listed, "nic" for the cores on the NUMA node of
+  //    the interface, "-" for any core
+  std::vector<int> ParseCores(const std::string &spec);
+  //Leave the cores serving the interrupts of the interface out of cores,
+  //    which are all the cores if empty, unless no core is left
+  void AvoidIrqs(std::vector<int> &cores);
+  //Print the cores and where the threads of each stage run
+  void Show(const ThreadOptions &options);
+
+  Count get_core_num();
+  int get_nic_node();
+  const std::vector<int>& get_irq_cores();
+
+  //Name the calling thread as the i-th of the role and pin it to the cores
+  //    of the role, nothing is changed for a role without name and cores
+  static void Place(const ThreadRole &role, const Count &i);
+  //"0-3,8", or "any" if empty
+  static std::string ListCores(const std::vector<int> &cores);
+
+  //CpuTopology is neither copyable nor movable
+  CpuTopology(const CpuTopology&) = delete;
+  CpuTopology& operator=(const CpuTopology&) = delete;
+
+ private:
+  Name eth_;
+  Count core_num_;
+  int nic_node_;                //-1 if unknown
+  std::vector<int> nic_cores_;  //Cores on the NUMA node of the interface
+  std::vector<int> irq_cores_;  //Cores serving the interrupts of it
+
+  //Parse a list like "0-3,8" of the cores which exist
+  std::vector<int> ParseList_(const std::string &list);
+  void LoadIrqCores_();
+
+  static const size_t kMaxNameLen; //Thread names are 15 chars at most
+};
+
+} // namespace exr
+
+#endif // EXR_UTIL_CPUTOPOLOGY_HH_
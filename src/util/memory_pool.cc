@@ -1,18 +1,111 @@
 #include "util/memory_pool.hh"
 
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
 namespace exr {
 
 //Constructor and destructor
-MemoryPool::MemoryPool(const Count &num, const DataSize &size)
-    : bufs_(new std::unique_ptr<BufUnit[]>[num]) {
-  for (Count i = 0; i < num; ++i)
-    bufs_[i] = std::make_unique<BufUnit[]>(size);
+MemoryPool::MemoryPool(const Count &num, const DataSize &size,
+                       const MemoryOptions &options)
+    : num_(num), size_(size), base_(nullptr), huge_(false) {
+  Map_(options);
+  if (options.numa_node >= 0) Bind_(options.numa_node);
+  if (options.prefault) Prefault_();
 }
 
-MemoryPool::~MemoryPool() = default;
+MemoryPool::~MemoryPool() {
+  if (base_) munmap(base_, map_size_);
+}
 
 BufUnit* MemoryPool::Get(const Count &id, const DataSize &offset) {
-  return bufs_[id].get() + offset;
+  return base_ + id * stride_ + offset;
 }
 
+Count MemoryPool::get_num() { return num_; }
+DataSize MemoryPool::get_size() { return size_; }
+bool MemoryPool::is_huge() { return huge_; }
+
+int MemoryPool::NicNode(const Name &eth_name) {
+  std::ifstream f("/sys/class/net/" + eth_name + "/device/numa_node");
+  int node = -1;
+  if (!(f >> node)) return -1;
+  return node;
+}
+
+//Huge pages of hugetlbfs need to be reserved, use transparent ones if not
+void MemoryPool::Map_(const MemoryOptions &options) {
+  auto align = options.huge_pages > 0 ? kHugePageSize : kPageSize;
+  stride_ = (size_ + align - 1) / align * align;
+  map_size_ = stride_ * (num_ > 0 ? num_ : 1);
+
+  void *p = MAP_FAILED;
+  if (options.huge_pages == 2) {
+    p = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED)
+      std::cerr << "Cannot map huge pages (" << strerror(errno)
+                << "), use transparent ones instead" << std::endl;
+    else
+      huge_ = true;
+  }
+  if (p == MAP_FAILED) {
+    p = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+      std::cerr << "Allocate memory pool error: " << strerror(errno)
+                << std::endl;
+      exit(-1);
+    }
+    if (options.huge_pages > 0 && madvise(p, map_size_, MADV_HUGEPAGE) < 0)
+      std::cerr << "Advise huge pages error: " << strerror(errno)
+                << std::endl;
+  }
+  base_ = static_cast<BufUnit*>(p);
+}
+
+//Should be done before the pages are faulted in
+void MemoryPool::Bind_(const int &node) {
+  const size_t bits = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> mask(node / bits + 1, 0);
+  mask[node / bits] = 1UL << (node % bits);
+  if (syscall(SYS_mbind, base_, map_size_, MPOL_BIND, mask.data(),
+              mask.size() * bits + 1, 0) < 0)
+    std::cerr << "Bind memory to node " << node << " error: "
+              << strerror(errno) << std::endl;
+}
+
+//Touch a byte of each page, the bufs are faulted in by several threads
+void MemoryPool::Prefault_() {
+  auto page = huge_ ? kHugePageSize : kPageSize;
+  Count thr_n = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+  if (thr_n > num_) thr_n = num_ > 0 ? num_ : 1;
+  std::vector<std::thread> threads;
+  for (Count t = 0; t < thr_n; ++t) {
+    threads.emplace_back([&, t] {
+      for (Count i = t; i < num_; i += thr_n)
+        for (DataSize off = 0; off < stride_; off += page)
+          base_[i * stride_ + off] = 0;
+    });
+  }
+  for (auto &th : threads) th.join();
+}
+
+//Static values
+const DataSize MemoryPool::kPageSize = 4096;
+const DataSize MemoryPool::kHugePageSize = 2 << 20;
+
 } // namespace exr
@@ -8,21 +8,44 @@
 
 namespace exr {
 
-/* Allocate several memory bufs in advandce. Get them when needed */
+/* Allocate several memory bufs in advandce. Get them when needed.
+ * The bufs are in one mapping, each starts at a page boundary and the
+ * pages are not touched until used unless prefault is set */
 class MemoryPool
 {
  public:
-  MemoryPool(const Count &num, const DataSize &size);
+  MemoryPool(const Count &num, const DataSize &size,
+             const MemoryOptions &options = MemoryOptions());
   ~MemoryPool();
 
   BufUnit* Get(const Count &id, const DataSize &offset);
 
+  Count get_num();
+  DataSize get_size();
+  //Whether the bufs are backed by huge pages of hugetlbfs
+  bool is_huge();
+
+  //NUMA node of a network interface, -1 if unknown
+  static int NicNode(const Name &eth_name);
+
   //MemoryPool is neither copyable nor movable
   MemoryPool(const MemoryPool&) = delete;
   MemoryPool& operator=(const MemoryPool&) = delete;
 
  private:
-  std::unique_ptr<std::unique_ptr<BufUnit[]>[]> bufs_; //Memory units
+  Count num_;
+  DataSize size_;
+  DataSize stride_;    //Distance between two bufs
+  DataSize map_size_;
+  BufUnit *base_;      //Memory units
+  bool huge_;
+
+  void Map_(const MemoryOptions &options);
+  void Bind_(const int &node);
+  void Prefault_();
+
+  static const DataSize kPageSize;
+  static const DataSize kHugePageSize;
 };
 
 } // namespace exr
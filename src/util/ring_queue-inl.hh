@@ -0,0 +1,160 @@
+/* Class RingQueue -- from "util/ring_queue.hh" */
+
+#include <thread>
+
+namespace exr {
+
+//Constructor and destructor, cell i is ready for the push at position i
+template <typename Data> RingQueue<Data>::RingQueue(const size_t &size)
+    : tail_(0), head_(0), spill_n_(0), pop_waiters_(0), close_flag_(false) {
+  size_t n = 2;
+  while (n < size) n <<= 1;
+  mask_ = n - 1;
+  cells_.reset(new Cell[n]);
+  for (size_t i = 0; i < n; ++i)
+    cells_[i].seq.store(i, std::memory_order_relaxed);
+}
+
+template <typename Data> RingQueue<Data>::~RingQueue() = default;
+
+//Insert data, into the spill if the ring is full or the spill is not
+//    empty, as the data spilled before should be taken first
+template <typename Data> void RingQueue<Data>::Push(Data data) {
+  if (TryPush(data) || close_flag_) return;
+  std::unique_lock<std::mutex> lck(mtx_);
+  spill_.push_back(std::move(data));
+  spill_n_.fetch_add(1, std::memory_order_release);
+  lck.unlock();
+  Wake_();
+}
+
+//Get earliest data, spin a while before sleeping if empty
+template <typename Data> Data RingQueue<Data>::Pop() {
+  Data data;
+  for (int i = 0; i < kSpinNum + kYieldNum; ++i) {
+    if (close_flag_) return Data();
+    if (TryPop(data)) return data;
+    if (i < kSpinNum) Relax_(); else std::this_thread::yield();
+  }
+  std::unique_lock<std::mutex> lck(mtx_);
+  ++pop_waiters_;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  pop_cv_.wait(lck, [&] {
+    return close_flag_ || Dequeue_(data) || Unspill_(data);
+  });
+  --pop_waiters_;
+  if (close_flag_) return Data();
+  return data;
+}
+
+template <typename Data>
+size_t RingQueue<Data>::PopBatch(Data *out, const size_t &max_n) {
+  if (max_n == 0) return 0;
+  out[0] = Pop();
+  if (close_flag_) return 0;
+  size_t n = 1;
+  while (n < max_n && TryPop(out[n])) ++n;
+  return n;
+}
+
+template <typename Data> bool RingQueue<Data>::TryPush(Data &data) {
+  if (spill_n_.load(std::memory_order_acquire) > 0 || !Enqueue_(data))
+    return false;
+  Wake_();
+  return true;
+}
+
+//The spill is taken only when the ring is empty
+template <typename Data> bool RingQueue<Data>::TryPop(Data &data) {
+  if (Dequeue_(data)) return true;
+  if (spill_n_.load(std::memory_order_acquire) == 0) return false;
+  std::unique_lock<std::mutex> lck(mtx_);
+  return Unspill_(data);
+}
+
+//Take the cell at the position by moving the position forward
+template <typename Data> bool RingQueue<Data>::Enqueue_(Data &data) {
+  Cell *cell;
+  auto pos = tail_.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &cells_[pos & mask_];
+    auto seq = cell->seq.load(std::memory_order_acquire);
+    auto dif = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+    if (dif == 0) {
+      if (tail_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed))
+        break;
+    } else if (dif < 0) {
+      return false;
+    } else {
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->data = std::move(data);
+  cell->seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename Data> bool RingQueue<Data>::Dequeue_(Data &data) {
+  Cell *cell;
+  auto pos = head_.load(std::memory_order_relaxed);
+  while (true) {
+    cell = &cells_[pos & mask_];
+    auto seq = cell->seq.load(std::memory_order_acquire);
+    auto dif = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos + 1);
+    if (dif == 0) {
+      if (head_.compare_exchange_weak(pos, pos + 1,
+                                      std::memory_order_relaxed))
+        break;
+    } else if (dif < 0) {
+      return false;
+    } else {
+      pos = head_.load(std::memory_order_relaxed);
+    }
+  }
+  data = std::move(cell->data);
+  //Ready for the push one round later
+  cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename Data> bool RingQueue<Data>::Unspill_(Data &data) {
+  if (spill_.empty()) return false;
+  data = std::move(spill_.front());
+  spill_.pop_front();
+  spill_n_.fetch_sub(1, std::memory_order_release);
+  return true;
+}
+
+//Close and wake up waiting threads
+template <typename Data> void RingQueue<Data>::Close() {
+  std::unique_lock<std::mutex> lck(mtx_);
+  close_flag_ = true;
+  lck.unlock();
+  pop_cv_.notify_all();
+}
+
+//The sleeping getters have counted themselves before their last try
+template <typename Data> void RingQueue<Data>::Wake_() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (pop_waiters_.load(std::memory_order_relaxed) == 0) return;
+  //A waiter holds the mutex from its last try until it sleeps
+  std::unique_lock<std::mutex> lck(mtx_);
+  lck.unlock();
+  pop_cv_.notify_one();
+}
+
+template <typename Data> void RingQueue<Data>::Relax_() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+//Static values
+template <typename Data> const size_t RingQueue<Data>::kDefaultSize = 1024;
+template <typename Data> const int RingQueue<Data>::kSpinNum = 64;
+template <typename Data> const int RingQueue<Data>::kYieldNum = 16;
+
+} // namespace exr
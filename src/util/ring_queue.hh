@@ -0,0 +1,87 @@
+#ifndef EXR_UTIL_RINGQUEUE_HH_
+#define EXR_UTIL_RINGQUEUE_HH_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace exr {
+
+/* A lock-free queue for many pushers and many getters, each cell of the
+ * ring has a sequence number telling whether it can be filled or taken
+ * (D. Vyukov's MPMC ring). Getters wait while it is empty, spinning a
+ * while before sleeping. Pushers never wait: while the ring is full the
+ * data spills into a locked list, which is taken after the ring and is
+ * filled until it is empty again, so the order is kept. A processor can
+ * push to its own queue or to a stage which feeds it back */
+template <typename Data>
+class RingQueue
+{
+ public:
+  //The size is rounded up to a power of 2
+  explicit RingQueue(const size_t &size = kDefaultSize);
+  ~RingQueue();
+
+  //Store data, spilled if the ring is full; get data, waiting if empty
+  void Push(Data data);
+  Data Pop();
+  //Wait for one data, then take at most max_n - 1 more which are ready,
+  //    return the number taken, 0 after closed
+  size_t PopBatch(Data *out, const size_t &max_n);
+  //Return false at once if full (or spilled) or empty,
+  //    data is kept if not pushed
+  bool TryPush(Data &data);
+  bool TryPop(Data &data);
+
+  //Wake up all the waiting threads, Pop returns Data() after closed
+  void Close();
+
+  //RingQueue is neither copyable nor movable
+  RingQueue(const RingQueue&) = delete;
+  RingQueue& operator=(const RingQueue&) = delete;
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    Data data;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  //The positions are on their own cache lines
+  char pad0_[64];
+  std::atomic<size_t> tail_; //Next to push
+  char pad1_[64];
+  std::atomic<size_t> head_; //Next to pop
+  char pad2_[64];
+
+  //Pushed while the ring is full, guarded by mtx_
+  std::deque<Data> spill_;
+  std::atomic<size_t> spill_n_;
+
+  //Only used when waiting for long
+  std::atomic<int> pop_waiters_;
+  std::mutex mtx_;
+  std::condition_variable pop_cv_;
+  std::atomic<bool> close_flag_;
+
+  bool Enqueue_(Data &data);
+  bool Dequeue_(Data &data);
+  //Take the earliest spilled data, mtx_ should be held
+  bool Unspill_(Data &data);
+  void Wake_();
+  static void Relax_();
+
+  static const size_t kDefaultSize;
+  static const int kSpinNum;  //Tries with a pause between
+  static const int kYieldNum; //Tries with a yield between
+};
+
+} // namespace exr
+
+#include "util/ring_queue-inl.hh"
+
+#endif // EXR_UTIL_RINGQUEUE_HH_
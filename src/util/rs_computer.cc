@@ -1,14 +1,59 @@
 #include "util/rs_computer.hh"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 #include "isa-l.h"
 
+#if defined(__x86_64__)
+#include <cpuid.h>
+
+//Kernels of ISA-L not in its header
+extern "C" {
+void ec_encode_data_avx512(int len, int k, int rows, unsigned char *g_tbls,
+                           unsigned char **data, unsigned char **coding);
+void ec_encode_data_update_avx512(int len, int k, int rows, int vec_i,
+                                  unsigned char *g_tbls, unsigned char *data,
+                                  unsigned char **coding);
+#ifdef EXR_WITH_GFNI
+void ec_init_tables_gfni(int k, int rows, unsigned char *a,
+                         unsigned char *gftbls);
+void ec_encode_data_avx512_gfni(int len, int k, int rows,
+                                unsigned char *g_tbls, unsigned char **data,
+                                unsigned char **coding);
+void ec_encode_data_update_avx512_gfni(int len, int k, int rows, int vec_i,
+                                       unsigned char *g_tbls,
+                                       unsigned char *data,
+                                       unsigned char **coding);
+#endif
+}
+#endif
+
 namespace exr {
 
+#if defined(__x86_64__)
+namespace {
+//The kernels of ISA-L need AVX512F, AVX512BW and AVX512VL
+bool HasAvx512() {
+  return __builtin_cpu_supports("avx512f") &&
+         __builtin_cpu_supports("avx512bw") &&
+         __builtin_cpu_supports("avx512vl");
+}
+
+#ifdef EXR_WITH_GFNI
+bool HasGfni() {
+  unsigned a, b, c, d;
+  return __get_cpuid_count(7, 0, &a, &b, &c, &d) && (c & (1 << 8));
+}
+#endif
+}
+#endif
+
 //Constructor and destructor
-RSComputer::RSComputer(const Count cn, const Count ck) : cn_(cn), ck_(ck) {}
+RSComputer::RSComputer(const Count cn, const Count ck)
+    : cn_(cn), ck_(ck), kernel_(nullptr) {}
 
 RSComputer::~RSComputer() = default;
 
@@ -20,42 +65,187 @@ void RSComputer::InitForDecode() {
 
 void RSComputer::Decode(const Count &tar_n, const Count *tars,
                         const Count *srcs, RSUnit* results) {
+  RSUnit *tempi = matrix_.get() + (cn_ + ck_) * ck_;
+  if (!Invert(srcs, tempi)) {
+    std::cout << "error when inverting matrix" << std::endl;
+    exit(-1);
+  }
+  for (Count i = 0; i < tar_n; ++i)
+    Combine(tempi, tars[i], results + i * ck_);
+}
+
+bool RSComputer::Invert(const Count *srcs, RSUnit *inv) {
   RSUnit *cauchy = matrix_.get();
   RSUnit *tempc = cauchy + cn_ * ck_;
-  RSUnit *tempi = tempc + ck_ * ck_;
   for (Count i = 0; i < ck_; ++i)
     memcpy(tempc + i * ck_, cauchy + srcs[i] * ck_, sizeof(RSUnit) * ck_);
+  return gf_invert_matrix(tempc, inv, ck_) == 0;
+}
 
-  if (gf_invert_matrix(tempc, tempi, ck_) < 0) {
-    std::cout << "error when inverting matrix" << std::endl;
-    exit(-1);
+void RSComputer::Combine(const RSUnit *inv, const Count &tar,
+                         RSUnit *coefs) {
+  if (tar < ck_) {
+    memcpy(coefs, inv + tar * ck_, sizeof(RSUnit) * ck_);
+    return;
   }
-
-  for (Count i = 0; i < tar_n; ++i) {
-    if (tars[i] < ck_) {
-      memcpy(results + i * ck_, tempi + tars[i] * ck_,
-             sizeof(RSUnit) * ck_);
-    } else {
-      for (Count j = 0; j < ck_; ++j) {
-        RSUnit s = 0;
-        for (Count k = 0; k < ck_; ++k)
-          s ^= gf_mul(tempi[k * ck_ + j], cauchy[tars[i] * ck_ + k]);
-        results[i * ck_ + j] = s;
-      }
-    }
+  RSUnit *cauchy = matrix_.get();
+  for (Count j = 0; j < ck_; ++j) {
+    RSUnit s = 0;
+    for (Count k = 0; k < ck_; ++k)
+      s ^= gf_mul(inv[k * ck_ + j], cauchy[tar * ck_ + k]);
+    coefs[j] = s;
   }
 }
 
 //Matrix encoding -- Multiply and XOR data
 void RSComputer::InitForEncode(RSUnit *coefs) {
-  matrix_ = std::make_unique<RSUnit[]>(32 * cn_ * ck_);
-  ec_init_tables(cn_, ck_, coefs, matrix_.get());
+  kernel_ = Current_();
+  matrix_ = std::make_unique<RSUnit[]>(kernel_->table_size * cn_ * ck_);
+  kernel_->init(cn_, ck_, coefs, matrix_.get());
 }
 
 void RSComputer::Encode(const DataSize &size, void *srcs, void *tars) {
-  ec_encode_data(size, cn_, ck_, matrix_.get(),
-                 reinterpret_cast<RSUnit**>(srcs),
-                 reinterpret_cast<RSUnit**>(tars));
+  kernel_->encode(size, cn_, ck_, matrix_.get(),
+                  reinterpret_cast<RSUnit**>(srcs),
+                  reinterpret_cast<RSUnit**>(tars));
 }
 
+//The dot product kernels
+void RSComputer::DotProd(const DataSize &size, const Count &n,
+                         const RSUnit *coefs, BufUnit **srcs,
+                         BufUnit *tar) {
+  if (std::all_of(coefs, coefs + n, [](RSUnit c) { return c == 1; })) {
+    Xor_(size, n, srcs, tar);
+    return;
+  }
+  const Kernel *kernel = Current_();
+  auto ts = kernel->table_size;
+  static thread_local std::vector<RSUnit> tables;
+  tables.resize(ts * n);
+  for (Count i = 0; i < n; ++i)
+    memcpy(tables.data() + i * ts, Tables_(kernel) + coefs[i] * ts, ts);
+  RSUnit *tars[1] = {reinterpret_cast<RSUnit*>(tar)};
+  kernel->encode(size, n, 1, tables.data(),
+                 reinterpret_cast<RSUnit**>(srcs), tars);
+}
+
+//The gf_vect_mad kernels
+void RSComputer::MulAdd(const DataSize &size, const RSUnit &coef,
+                        BufUnit *src, BufUnit *tar) {
+  if (coef == 1) {
+    BufUnit *srcs[2] = {src, tar};
+    Xor_(size, 2, srcs, tar);
+    return;
+  }
+  const Kernel *kernel = Current_();
+  RSUnit *tars[1] = {reinterpret_cast<RSUnit*>(tar)};
+  kernel->update(size, 1, 1, 0, const_cast<RSUnit*>(Tables_(kernel)) +
+                 coef * kernel->table_size,
+                 reinterpret_cast<RSUnit*>(src), tars);
+}
+
+//The kernels may read the tail of the source again after writing the
+//    target, so a chunk is copied out first and multiplied back, the copy
+//    stays in the cache
+void RSComputer::Mul(const DataSize &size, const RSUnit &coef,
+                     BufUnit *buf) {
+  if (coef == 1) return;
+  static thread_local std::vector<BufUnit> chunk(kMulChunk);
+  for (DataSize offset = 0; offset < size; offset += kMulChunk) {
+    auto s = std::min(kMulChunk, size - offset);
+    memcpy(chunk.data(), buf + offset, s);
+    BufUnit *srcs[1] = {chunk.data()};
+    DotProd(s, 1, &coef, srcs, buf + offset);
+  }
+}
+
+const std::vector<RSComputer::Kernel>& RSComputer::Kernels() {
+  static const std::vector<Kernel> kernels = {
+    {"base", [] { return true; }, InitTables_, kTableSize,
+     ec_encode_data_base, ec_encode_data_update_base},
+#if defined(__x86_64__)
+    {"ssse3", [] { return __builtin_cpu_supports("ssse3") != 0; },
+     InitTables_, kTableSize, ec_encode_data_sse, ec_encode_data_update_sse},
+    {"avx", [] { return __builtin_cpu_supports("avx") != 0; },
+     InitTables_, kTableSize, ec_encode_data_avx, ec_encode_data_update_avx},
+    {"avx2", [] { return __builtin_cpu_supports("avx2") != 0; },
+     InitTables_, kTableSize, ec_encode_data_avx2,
+     ec_encode_data_update_avx2},
+    {"avx512", HasAvx512, InitTables_, kTableSize, ec_encode_data_avx512,
+     ec_encode_data_update_avx512},
+#ifdef EXR_WITH_GFNI
+    {"gfni", [] { return HasAvx512() && HasGfni(); }, ec_init_tables_gfni,
+     kGfniTableSize, ec_encode_data_avx512_gfni,
+     ec_encode_data_update_avx512_gfni},
+#endif
+#endif
+  };
+  return kernels;
+}
+
+bool RSComputer::UseKernel(const Name &name) {
+  for (auto &kernel : Kernels()) {
+    if (kernel.name != name) continue;
+    if (!kernel.supported()) return false;
+    Current_() = &kernel;
+    return true;
+  }
+  return false;
+}
+
+const Name& RSComputer::GetKernel() { return Current_().load()->name; }
+
+//The last one supported is the fastest
+std::atomic<const RSComputer::Kernel*>& RSComputer::Current_() {
+  static std::atomic<const Kernel*> current([] {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+#endif
+    const Kernel *best = nullptr;
+    for (auto &kernel : Kernels())
+      if (kernel.supported()) best = &kernel;
+    return best;
+  }());
+  return current;
+}
+
+const RSUnit* RSComputer::Tables_(const Kernel *kernel) {
+  static std::vector<std::unique_ptr<RSUnit[]>> tables = [] {
+    std::vector<std::unique_ptr<RSUnit[]>> all;
+    std::vector<RSUnit> coefs(256);
+    for (int c = 0; c < 256; ++c) coefs[c] = c;
+    for (auto &k : Kernels()) {
+      all.push_back(std::make_unique<RSUnit[]>(256 * k.table_size));
+      k.init(256, 1, coefs.data(), all.back().get());
+    }
+    return all;
+  }();
+  return tables[kernel - Kernels().data()].get();
+}
+
+//The target may be the last source
+void RSComputer::Xor_(const DataSize &size, const Count &n, BufUnit **srcs,
+                      BufUnit *tar) {
+  if (n == 1) {
+    if (srcs[0] != tar) memcpy(tar, srcs[0], size);
+    return;
+  }
+  static thread_local std::vector<void*> array;
+  array.assign(srcs, srcs + n);
+  array.push_back(tar);
+  xor_gen(n + 1, size, array.data());
+}
+
+//The same layout as ec_init_tables, which may give the tables of GFNI
+void RSComputer::InitTables_(int k, int rows, RSUnit *coefs,
+                             RSUnit *tables) {
+  for (int i = 0; i < rows * k; ++i)
+    gf_vect_mul_init(coefs[i], tables + i * kTableSize);
+}
+
+//Static values
+const DataSize RSComputer::kTableSize = 32;
+const DataSize RSComputer::kGfniTableSize = 8;
+const DataSize RSComputer::kMulChunk = 4096;
+
 } // namespace exr
@@ -1,16 +1,33 @@
 #ifndef EXR_UTIL_RSCOMPUTER_HH_
 #define EXR_UTIL_RSCOMPUTER_HH_
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "util/typedef.hh"
 
 namespace exr {
 
-/* Used for erasure code computation */
+/* Used for erasure code computation. The multiply and add is done by one
+ * of the kernels of ISA-L, the fastest one the CPU supports unless another
+ * one is chosen */
 class RSComputer
 {
  public:
+  struct Kernel {
+    Name name;
+    bool (*supported)();
+    //Expand the coefficients (rows * k) into tables
+    void (*init)(int k, int rows, RSUnit *coefs, RSUnit *tables);
+    DataSize table_size; //Bytes of the table of a coefficient
+    void (*encode)(int len, int k, int rows, RSUnit *tables,
+                   RSUnit **srcs, RSUnit **tars);
+    //Add the vec_i-th of the k sources to the targets
+    void (*update)(int len, int k, int rows, int vec_i, RSUnit *tables,
+                   RSUnit *src, RSUnit **tars);
+  };
+
   //(cn, ck) represents: (n, k) for Erasure Code when decoding,
   //                     (in, out) when encoding
   RSComputer(Count cn, Count ck);
@@ -20,11 +37,35 @@ class RSComputer
   void InitForDecode();
   void Decode(const Count &tar_n, const Count *tars, const Count *srcs,
               RSUnit* results);
+  //The two steps of Decode: invert the rows of the k sources into inv
+  //    (k * k), false if they are not independent; then get the k coefs
+  //    of the target on the sources
+  bool Invert(const Count *srcs, RSUnit *inv);
+  void Combine(const RSUnit *inv, const Count &tar, RSUnit *coefs);
 
   //Encode data using Multiply and XOR
   void InitForEncode(RSUnit *coefs); //lenth of coefs is cn * ck
   void Encode(const DataSize &size, void *srcs, void *tars);
 
+  //Fused kernels with any coefficients, each is one pass over the data,
+  //    a plain XOR if all the coefficients are 1
+  //tar = coefs[0] * srcs[0] + ... + coefs[n - 1] * srcs[n - 1],
+  //    tar should not be one of srcs
+  static void DotProd(const DataSize &size, const Count &n,
+                      const RSUnit *coefs, BufUnit **srcs, BufUnit *tar);
+  //tar += coef * src, in place
+  static void MulAdd(const DataSize &size, const RSUnit &coef,
+                     BufUnit *src, BufUnit *tar);
+  //buf = coef * buf, in place
+  static void Mul(const DataSize &size, const RSUnit &coef, BufUnit *buf);
+
+  //The kernels built in, from the slowest
+  static const std::vector<Kernel>& Kernels();
+  //Use the kernel for the computers initialized later and the fused
+  //    kernels, false if the CPU doesn't support it
+  static bool UseKernel(const Name &name);
+  static const Name& GetKernel();
+
   //RSComputer is neither copyable nor movable
   RSComputer(const RSComputer&) = delete;
   RSComputer& operator=(const RSComputer&) = delete;
@@ -33,6 +74,20 @@ class RSComputer
   Count cn_;
   Count ck_;
   std::unique_ptr<RSUnit[]> matrix_;
+  const Kernel *kernel_; //The one when initialized for encoding
+
+  //The kernel in use, chosen by the CPU features at first
+  static std::atomic<const Kernel*>& Current_();
+  //Tables of all the coefficients expanded by each kernel
+  static const RSUnit* Tables_(const Kernel *kernel);
+  //Tables of the kernels not using GFNI
+  static void InitTables_(int k, int rows, RSUnit *coefs, RSUnit *tables);
+  static void Xor_(const DataSize &size, const Count &n, BufUnit **srcs,
+                   BufUnit *tar);
+
+  static const DataSize kTableSize;     //32 for the shuffle kernels
+  static const DataSize kGfniTableSize; //8, an affine matrix
+  static const DataSize kMulChunk;      //Bytes multiplied at a time by Mul
 };
 
 } // namespace exr
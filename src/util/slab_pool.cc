@@ -0,0 +1,123 @@
+#include "util/slab_pool.hh"
+
+#include <iostream>
+
+namespace exr {
+
+//Constructor and destructor
+SlabPool::SlabPool(const DataSize &slice_size, const uint32_t &num,
+                   const MemoryOptions &options)
+    : slice_size_(slice_size),
+      stride_((slice_size + kAlign - 1) / kAlign * kAlign), num_(num),
+      mp_(1, stride_ * num, options), head_(kNone),
+      next_(std::make_unique<std::atomic<uint32_t>[]>(num)),
+      refs_(std::make_unique<std::atomic<uint32_t>[]>(num)),
+      free_num_(0), peak_num_(0), waiters_(0) {
+  if (slice_size <= 0 || num == 0 || num == kNone) {
+    std::cerr << "Invalid slab pool of " << num << " slices with size "
+              << slice_size << std::endl;
+    exit(-1);
+  }
+  //The first slice is on the top
+  for (uint32_t i = num; i > 0; --i) {
+    refs_[i - 1] = 0;
+    Push_(i - 1);
+  }
+}
+
+SlabPool::~SlabPool() {}
+
+BufUnit* SlabPool::Get() {
+  uint32_t idx;
+  if (!Pop_(idx)) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    ++waiters_;
+    cv_.wait(lck, [&] { return Pop_(idx); });
+    --waiters_;
+  }
+  return Take_(idx);
+}
+
+BufUnit* SlabPool::TryGet() {
+  uint32_t idx;
+  if (!Pop_(idx)) return nullptr;
+  return Take_(idx);
+}
+
+void SlabPool::Ref(BufUnit *buf) {
+  if (!buf) return;
+  refs_[Index_(buf)].fetch_add(1, std::memory_order_relaxed);
+}
+
+//No one else can take a reference to a slice only the caller holds, so a
+//    slice found not shared stays so
+bool SlabPool::IsShared(BufUnit *buf) {
+  return refs_[Index_(buf)].load(std::memory_order_acquire) > 1;
+}
+
+//The one dropping the last reference returns the slice
+void SlabPool::Put(BufUnit *buf) {
+  if (!buf) return;
+  auto idx = Index_(buf);
+  auto refs = refs_[idx].fetch_sub(1, std::memory_order_acq_rel);
+  if (refs == 0) {
+    std::cerr << "Slice " << idx << " is put more than got" << std::endl;
+    exit(-1);
+  }
+  if (refs > 1) return;
+  Push_(idx);
+  if (waiters_ > 0) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    cv_.notify_one();
+  }
+}
+
+DataSize SlabPool::get_slice_size() { return slice_size_; }
+uint32_t SlabPool::get_num() { return num_; }
+uint32_t SlabPool::get_free_num() { return free_num_; }
+uint32_t SlabPool::get_peak_num() { return peak_num_; }
+
+bool SlabPool::Pop_(uint32_t &idx) {
+  auto head = head_.load();
+  do {
+    idx = static_cast<uint32_t>(head);
+    if (idx == kNone) return false;
+    //The tag fails the exchange if the slice is popped and pushed back
+  } while (!head_.compare_exchange_weak(
+      head, ((head >> 32) + 1) << 32 | next_[idx].load(
+          std::memory_order_relaxed)));
+  --free_num_;
+  return true;
+}
+
+void SlabPool::Push_(const uint32_t &idx) {
+  auto head = head_.load(std::memory_order_relaxed);
+  do {
+    next_[idx].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+  } while (!head_.compare_exchange_weak(head,
+                                        ((head >> 32) + 1) << 32 | idx));
+  ++free_num_;
+}
+
+uint32_t SlabPool::Index_(BufUnit *buf) {
+  auto pos = buf - mp_.Get(0, 0);
+  if (pos < 0 || pos >= stride_ * num_ || pos % stride_ != 0) {
+    std::cerr << "Buffer is not a slice of the pool" << std::endl;
+    exit(-1);
+  }
+  return static_cast<uint32_t>(pos / stride_);
+}
+
+BufUnit* SlabPool::Take_(const uint32_t &idx) {
+  refs_[idx].store(1, std::memory_order_relaxed);
+  auto used = num_ - free_num_.load(std::memory_order_relaxed);
+  auto peak = peak_num_.load(std::memory_order_relaxed);
+  while (used > peak && !peak_num_.compare_exchange_weak(peak, used)) {}
+  return mp_.Get(0, idx * stride_);
+}
+
+//Static values
+const uint32_t SlabPool::kNone = UINT32_MAX;
+const DataSize SlabPool::kAlign = 64;
+
+} // namespace exr
@@ -0,0 +1,77 @@
+#ifndef EXR_UTIL_SLABPOOL_HH_
+#define EXR_UTIL_SLABPOOL_HH_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "util/memory_pool.hh"
+#include "util/typedef.hh"
+
+namespace exr {
+
+/* Slices of the same size for the pieces in flight, shared by all the tasks
+ * and all the nodes. A slice has a reference count and goes back to the
+ * pool when the last reference is dropped. The free slices are kept in a
+ * lock-free stack, the most recently freed one is reused first so that
+ * only the slices ever in flight at the same time are touched */
+class SlabPool
+{
+ public:
+  SlabPool(const DataSize &slice_size, const uint32_t &num,
+           const MemoryOptions &options = MemoryOptions());
+  ~SlabPool();
+
+  //Get a slice with one reference, wait if all are in use
+  BufUnit* Get();
+  //nullptr if all are in use
+  BufUnit* TryGet();
+  //Add or drop a reference, nullptr is ignored
+  void Ref(BufUnit *buf);
+  void Put(BufUnit *buf);
+  //More than one reference, the content should not be changed in place
+  bool IsShared(BufUnit *buf);
+
+  DataSize get_slice_size();
+  uint32_t get_num();
+  uint32_t get_free_num();
+  //Most slices in use at the same time
+  uint32_t get_peak_num();
+
+  //SlabPool is neither copyable nor movable
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+
+ private:
+  DataSize slice_size_;
+  DataSize stride_;    //Distance between two slices
+  uint32_t num_;
+  MemoryPool mp_;
+
+  //Top of the free stack: a tag in the high half against ABA,
+  //    the slice index in the low half
+  std::atomic<uint64_t> head_;
+  std::unique_ptr<std::atomic<uint32_t>[]> next_;
+  std::unique_ptr<std::atomic<uint32_t>[]> refs_;
+  std::atomic<uint32_t> free_num_;
+  std::atomic<uint32_t> peak_num_;
+
+  //Only used when the pool is empty
+  std::atomic<uint32_t> waiters_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+
+  bool Pop_(uint32_t &idx);
+  void Push_(const uint32_t &idx);
+  uint32_t Index_(BufUnit *buf);
+  BufUnit* Take_(const uint32_t &idx);
+
+  static const uint32_t kNone;
+  static const DataSize kAlign;
+};
+
+} // namespace exr
+
+#endif // EXR_UTIL_SLABPOOL_HH_
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "util/coef_cache.hh"
+#include "util/rs_computer.hh"
+
+int main()
+{
+  const exr::Count n = 14, k = 10, rounds = 10000;
+
+  //Repair random nodes from random sources, compare with RSComputer
+  exr::RSComputer rc(n, k);
+  rc.InitForDecode();
+  exr::CoefCache cache(n, k, 64);
+  std::vector<exr::Count> nodes(n);
+  std::iota(nodes.begin(), nodes.end(), 0);
+  exr::RSUnit expect[k], got[n * k];
+  int wrong = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i) {
+    //Few patterns recur, as the stripes of one failed node
+    std::mt19937 gen(i % 50);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    std::shuffle(nodes.begin(), nodes.end(), gen);
+    exr::Count tar = nodes[k], *srcs = nodes.data();
+    rc.Decode(1, &tar, srcs, expect);
+    cache.Decode(1, &tar, srcs, got);
+    if (memcmp(expect, got, k) != 0) ++wrong;
+  }
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  std::cout << rounds << " decodes in " << us << " us, wrong: " << wrong
+            << std::endl
+            << "hits: " << cache.get_hits() << ", misses: "
+            << cache.get_misses() << ", cached: " << cache.get_size()
+            << std::endl;
+
+  //All the failure patterns
+  exr::CoefCache full(n, k, 2048);
+  start = std::chrono::steady_clock::now();
+  auto num = full.Precompute();
+  us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  std::cout << std::endl << "precomputed " << num << " source sets in "
+            << us << " us" << std::endl;
+  start = std::chrono::steady_clock::now();
+  std::mt19937 gen;
+  for (int i = 0; i < rounds; ++i) {
+    std::shuffle(nodes.begin(), nodes.end(), gen);
+    full.Decode(n - k, nodes.data() + k, nodes.data(), got);
+  }
+  us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  std::cout << rounds << " decodes of " << n - k << " targets in " << us
+            << " us, misses: " << full.get_misses() << std::endl;
+  return 0;
+}
@@ -1,3 +1,5 @@
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <thread>
@@ -5,6 +7,15 @@
 #include "util/memory_pool.hh"
 #include "util/typedef.hh"
 
+//Time of writing all the blocks once, in milliseconds
+double TouchAll(exr::MemoryPool &mp) {
+  auto start = std::chrono::steady_clock::now();
+  for (exr::Count i = 0; i < mp.get_num(); ++i)
+    memset(mp.Get(i, 0), i, mp.get_size());
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count() / 1e3;
+}
+
 int main()
 {
   const exr::Count buf_num = 17;
@@ -12,8 +23,36 @@ int main()
   //
   //Init
   std::cout << "Initiate -- allocate blocks" << std::endl;
+  auto start = std::chrono::steady_clock::now();
   exr::MemoryPool mp(buf_num, size);
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  auto first = TouchAll(mp), second = TouchAll(mp);
   std::cout << "Allocated " << buf_num << " blocks with size: " << size
+            << " in " << us << " us" << std::endl
+            << "First write: " << first << " ms, second write: "
+            << second << " ms" << std::endl
+            << "Aligned to pages: "
+            << (reinterpret_cast<uintptr_t>(mp.Get(1, 0)) % 4096 == 0)
             << std::endl;
+
+  //Huge pages, faulted in when allocating, on the node of the interface
+  exr::MemoryOptions options;
+  options.huge_pages = 2;
+  options.prefault = true;
+  options.numa_node = exr::MemoryPool::NicNode("eth0");
+  if (options.numa_node < 0) options.numa_node = 0;
+  std::cout << std::endl << "Allocate with huge pages on node "
+            << options.numa_node << std::endl;
+  start = std::chrono::steady_clock::now();
+  exr::MemoryPool hmp(buf_num, size, options);
+  us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  first = TouchAll(hmp);
+  second = TouchAll(hmp);
+  std::cout << "Hugetlbfs: " << hmp.is_huge() << ", allocated in " << us
+            << " us" << std::endl
+            << "First write: " << first << " ms, second write: "
+            << second << " ms" << std::endl;
   return 0;
 }
@@ -0,0 +1,88 @@
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "util/ring_queue.hh"
+#include "util/waiting_queue.hh"
+
+//Each thread pushes and pops in turn, millions of pairs per second
+template <typename Queue>
+double Bench(const int &thr_num, const int &total) {
+  Queue q;
+  std::vector<std::thread> ts;
+  auto times = total / thr_num;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < thr_num; ++i) {
+    ts.emplace_back([&, i] {
+      for (int j = 0; j < times; ++j) {
+        q.Push(j);
+        q.Pop();
+      }
+    });
+  }
+  for (auto &t : ts) t.join();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  q.Close();
+  return static_cast<double>(times) * thr_num / us;
+}
+
+int main()
+{
+  const int total = 1 << 21;
+
+  //Correctness: all the pushed values are popped once
+  exr::RingQueue<int> rq(64);
+  const int thr_num = 8, times = 100000;
+  std::vector<std::thread> ts;
+  std::vector<int> sums(thr_num, 0);
+  for (int i = 0; i < thr_num; ++i) {
+    ts.emplace_back([&] { for (int j = 1; j <= times; ++j) rq.Push(j); });
+    ts.emplace_back([&, i] {
+      for (int j = 0; j < times; ++j) sums[i] += rq.Pop() % 7;
+    });
+  }
+  for (auto &t : ts) t.join();
+  int sum = 0, expected = 0;
+  for (auto s : sums) sum += s;
+  for (int j = 1; j <= times; ++j) expected += j % 7;
+  std::cout << "All popped once: " << (sum == expected * thr_num)
+            << std::endl;
+
+  //A getter pushing back more than it takes, as a stage which feeds
+  //    itself, while the ring is full
+  exr::RingQueue<int> fq(4);
+  const int roots = 64, depth = 3, nodes = roots * ((2 << depth) - 1);
+  std::atomic<int> taken(0);
+  std::thread getter([&] {
+    for (int i = 0; i < nodes; ++i) {
+      auto v = fq.Pop();
+      if (v > 0) {
+        fq.Push(v - 1);
+        fq.Push(v - 1);
+      }
+      ++taken;
+    }
+  });
+  for (int i = 0; i < roots; ++i) fq.Push(depth);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (taken < nodes && std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  std::cout << "Re-pushed all without blocking: " << (taken == nodes)
+            << std::endl << std::endl;
+  fq.Close();
+  getter.join();
+
+  //Throughput
+  std::cout << "threads  WaitingQueue  RingQueue  (M pairs/s)" << std::endl;
+  for (int n = 1; n <= 64; n *= 2) {
+    auto wq = Bench<exr::WaitingQueue<int>>(n, total);
+    auto rq = Bench<exr::RingQueue<int>>(n, total);
+    std::cout << std::setw(7) << n << std::setw(14) << wq
+              << std::setw(11) << rq << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "util/rs_computer.hh"
+
+const exr::Count src_num = 4;
+const exr::DataSize max_size = 1 << 20;
+const exr::DataSize total = 1 << 30; //Bytes read in each round
+
+//GB/s of the sources read by the function called on size bytes
+template<typename F>
+double Measure(const exr::DataSize &size, F &&f) {
+  auto rounds = total / (size * src_num);
+  f();
+  auto start = std::chrono::steady_clock::now();
+  for (exr::DataSize i = 0; i < rounds; ++i) f();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  return static_cast<double>(rounds) * size * src_num / ns;
+}
+
+int main()
+{
+  std::vector<std::vector<exr::BufUnit>> bufs(src_num + 2,
+      std::vector<exr::BufUnit>(max_size));
+  for (auto &buf : bufs)
+    for (auto &b : buf) b = rand();
+  exr::BufUnit *srcs[src_num];
+  for (exr::Count i = 0; i < src_num; ++i) srcs[i] = bufs[i].data();
+  auto tar = bufs[src_num].data(), ref = bufs[src_num + 1].data();
+  exr::RSUnit coefs[src_num] = {0x1d, 0x8e, 0x47, 0xad};
+
+  //The result of the base kernel is the reference of the others
+  exr::RSComputer::UseKernel("base");
+  exr::RSComputer::DotProd(max_size, src_num, coefs, srcs, ref);
+
+  std::cout << std::fixed << std::setprecision(2)
+            << "GB/s of the sources, dot product of " << src_num
+            << " and multiply-add of " << src_num << " in turn" << std::endl;
+  for (auto &kernel : exr::RSComputer::Kernels()) {
+    if (!exr::RSComputer::UseKernel(kernel.name)) {
+      std::cout << kernel.name << ": not supported" << std::endl;
+      continue;
+    }
+    exr::RSComputer::DotProd(max_size, src_num, coefs, srcs, tar);
+    std::cout << kernel.name << ":"
+              << (memcmp(tar, ref, max_size) ? " WRONG" : "") << std::endl;
+    for (exr::DataSize size = 1 << 12; size <= max_size; size <<= 2) {
+      auto dot = Measure(size, [&] {
+        exr::RSComputer::DotProd(size, src_num, coefs, srcs, tar);
+      });
+      auto mad = Measure(size, [&] {
+        for (exr::Count i = 0; i < src_num; ++i)
+          exr::RSComputer::MulAdd(size, coefs[i], srcs[i], tar);
+      });
+      std::cout << "\t" << std::setw(7) << size / 1024 << "K: dot "
+                << std::setw(7) << dot << ", mad " << std::setw(7) << mad
+                << std::endl;
+    }
+  }
+  return 0;
+}
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <iostream>
 #include <memory>
 
@@ -58,5 +59,19 @@ int main()
             << "coefs:" << std::endl
             << "\t" << static_cast<int>(coefs2[0]) << " "
                     << static_cast<int>(coefs2[1]) << std::endl;
+
+  //Multiply in place, the size is not a multiple of the chunks or the
+  //    vectors
+  const exr::DataSize size = 10007;
+  auto piece = std::make_unique<exr::BufUnit[]>(size);
+  auto product = std::make_unique<exr::BufUnit[]>(size);
+  for (exr::DataSize i = 0; i < size; ++i)
+    piece[i] = static_cast<exr::BufUnit>(i * 7 + 3);
+  exr::RSUnit coef = 29;
+  exr::BufUnit *srcs3[1] = {piece.get()};
+  exr::RSComputer::DotProd(size, 1, &coef, srcs3, product.get());
+  exr::RSComputer::Mul(size, coef, piece.get());
+  std::cout << std::endl << "multiply in place correct: "
+            << (memcmp(piece.get(), product.get(), size) == 0) << std::endl;
   return 0;
 }
@@ -0,0 +1,71 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "util/slab_pool.hh"
+#include "util/typedef.hh"
+
+int main()
+{
+  const exr::DataSize psize = 32768;
+  const uint32_t num = 64;
+  const int thr_n = 8, times = 100000;
+
+  //References
+  exr::SlabPool sp(psize, num);
+  auto a = sp.Get(), b = sp.Get();
+  sp.Ref(a);
+  sp.Put(a);
+  std::cout << "Free after two gets and one of two puts: "
+            << sp.get_free_num() << std::endl;
+  sp.Put(a);
+  std::cout << "Reused the last freed one: " << (sp.Get() == a) << std::endl;
+  sp.Put(a);
+  sp.Put(b);
+
+  //Run out
+  exr::BufUnit *bufs[num];
+  for (uint32_t i = 0; i < num; ++i) bufs[i] = sp.Get();
+  std::cout << "Empty: " << (sp.TryGet() == nullptr) << std::endl;
+  auto start = std::chrono::steady_clock::now();
+  std::thread t([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    sp.Put(bufs[7]);
+  });
+  auto got = sp.Get();
+  std::cout << "Waited for a put: " << (got == bufs[7]) << " in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start).count()
+            << " ms" << std::endl;
+  t.join();
+  bufs[7] = got;
+  for (uint32_t i = 0; i < num; ++i) sp.Put(bufs[i]);
+
+  //Threads get, fill, check and put the slices, no slice is given to two
+  std::atomic<int> wrong(0);
+  std::thread ts[thr_n];
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < thr_n; ++i) {
+    ts[i] = std::thread([&, i] {
+      for (int j = 0; j < times; ++j) {
+        auto buf = sp.Get();
+        memset(buf, i, 64);
+        std::this_thread::yield();
+        for (int k = 0; k < 64; ++k)
+          if (buf[k] != i) ++wrong;
+        sp.Put(buf);
+      }
+    });
+  }
+  for (int i = 0; i < thr_n; ++i) ts[i].join();
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  std::cout << thr_n * times << " gets and puts by " << thr_n
+            << " threads in " << us << " us, wrong bytes: " << wrong
+            << std::endl
+            << "Free: " << sp.get_free_num() << " of " << sp.get_num()
+            << ", at most " << sp.get_peak_num() << " in use" << std::endl;
+  return 0;
+}
@@ -0,0 +1,44 @@
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "util/token_bucket.hh"
+
+int main()
+{
+  const int thr_num = 4;
+  const exr::DataSize psize = 1 << 15, total = 1 << 24;
+  const double rate = 16e6;
+
+  //Several threads share one bucket, the total rate is limited
+  exr::TokenBucket tb;
+  tb.SetRate(rate, psize);
+  std::cout << "Rate: " << tb.get_rate() << " bytes/s" << std::endl;
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread t[thr_num];
+  for (int i = 0; i < thr_num; ++i) {
+    t[i] = std::thread([&] {
+      for (exr::DataSize s = 0; s < total / thr_num; s += psize)
+        tb.Consume(psize);
+    });
+  }
+  for (int i = 0; i < thr_num; ++i)
+    t[i].join();
+  double us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+
+  std::cout << thr_num << " threads consumed " << total << " bytes in "
+            << us << " us, expected " << (total - psize) / rate * 1e6
+            << " us" << std::endl;
+
+  //No limit
+  tb.SetRate(0, 0);
+  start = std::chrono::steady_clock::now();
+  for (exr::DataSize s = 0; s < total; s += psize)
+    tb.Consume(psize);
+  us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  std::cout << "Without limit: " << us << " us" << std::endl;
+  return 0;
+}
@@ -0,0 +1,45 @@
+#include "util/token_bucket.hh"
+
+#include <thread>
+
+namespace exr {
+
+//Constructor
+TokenBucket::TokenBucket()
+    : rate_(0), burst_(0), tokens_(0), last_(Clock::now()) {}
+
+//Set the rate, the tokens are refilled from now
+void TokenBucket::SetRate(const double &rate, const DataSize &burst) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  rate_ = rate / 1e6;
+  burst_ = burst;
+  tokens_ = burst_;
+  last_ = Clock::now();
+}
+
+//Refill by the time passed, then take the tokens even if not enough
+void TokenBucket::Consume(const DataSize &size) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  if (rate_ <= 0) return;
+  auto now = Clock::now();
+  double us = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      now - last_).count() / 1e3;
+  last_ = now;
+  tokens_ += us * rate_;
+  if (tokens_ > burst_) tokens_ = burst_;
+  tokens_ -= size;
+  if (tokens_ >= 0) return;
+
+  //Wait for the tokens of this consumer and those before it
+  auto wait = std::chrono::microseconds(
+      static_cast<int64_t>(-tokens_ / rate_));
+  lck.unlock();
+  std::this_thread::sleep_until(now + wait);
+}
+
+double TokenBucket::get_rate() {
+  std::unique_lock<std::mutex> lck(mtx_);
+  return rate_ * 1e6;
+}
+
+} // namespace exr
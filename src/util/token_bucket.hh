@@ -0,0 +1,42 @@
+#ifndef EXR_UTIL_TOKENBUCKET_HH_
+#define EXR_UTIL_TOKENBUCKET_HH_
+
+#include <chrono>
+#include <mutex>
+
+#include "util/typedef.hh"
+
+namespace exr {
+
+/* Limit the rate of bytes passing through, a caller takes the tokens at once
+ * and sleeps until the debt is paid, so the callers are served in order */
+class TokenBucket
+{
+ public:
+  TokenBucket();
+  ~TokenBucket() = default;
+
+  //Set the rate in bytes per second and the burst size, rate 0 for no limit
+  void SetRate(const double &rate, const DataSize &burst);
+  //Take size tokens, wait until they are available
+  void Consume(const DataSize &size);
+
+  double get_rate();
+
+  //TokenBucket is neither copyable nor movable
+  TokenBucket(const TokenBucket&) = delete;
+  TokenBucket& operator=(const TokenBucket&) = delete;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  std::mutex mtx_;
+  double rate_;   //Bytes per microsecond
+  double burst_;  //Max tokens
+  double tokens_; //Negative if in debt
+  Clock::time_point last_;
+};
+
+} // namespace exr
+
+#endif // EXR_UTIL_TOKENBUCKET_HH_
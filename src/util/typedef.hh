@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace exr {
 
@@ -19,6 +20,11 @@ using Alg = char;
 using DataSize = ssize_t;
 using BufUnit = char;
 using RSUnit = unsigned char;
+struct MemoryOptions {
+  Count huge_pages = 0;  //0, normal pages; 1, transparent; 2, hugetlbfs
+  bool prefault = false; //Fault the pages in when allocating, not when used
+  int numa_node = -1;    //NUMA node to place the memory on, -1 for any
+};
 
 //Socket
 using IP = std::string;
@@ -35,8 +41,43 @@ struct Bandwidth {
   BwType upload;
   BwType download;
 };
+
+//Access
+struct SocketProfile {
+  bool no_delay = true;   //Disable Nagle's algorithm (TCP_NODELAY)
+  bool quick_ack = false; //Acknowledge at once after receiving (TCP_QUICKACK)
+  bool cork = false;      //Hold the header until the content (TCP_CORK)
+  Count busy_poll = 0;    //Microseconds of busy polling, 0 for not
+  DataSize buf_size = 0;  //SO_SNDBUF and SO_RCVBUF, 0 for the default
+};
+struct AccessOptions {
+  bool zero_copy = false;  //Send large messages with MSG_ZEROCOPY
+  Count stream_num = 1;    //Number of connections to each node
+  bool stripe_by_offset = false; //Assign pieces to connections by offset
+  bool shared_memory = false; //Use shared memory for nodes on the same host
+  bool token_bucket = false; //Limit the bandwidth here, not by wondershaper
+  Count connect_timeout = 60; //Seconds to wait for others, 0 for no limit
+  SocketProfile socket;    //Tuning of the TCP sockets
+  Count codec = 0;         //Compression: 0, none; 1, LZ4; 2, zstd
+  int codec_level = 1;     //Level of zstd, or acceleration of LZ4
+  BwType compress_below = 0; //Compress on links slower than it (Kbps)
+  Count credit_slices = 0; //Pieces in flight to a node, 0 for no limit
+};
+
 using TTime = ssize_t;
 
+//Threads
+struct ThreadRole {        //Threads of a stage, named name-i
+  Name name;
+  std::vector<int> cores;  //Cores to run on, empty for any
+  bool isolate = false;    //Each thread on one of the cores in turn
+};
+struct ThreadOptions {
+  ThreadRole recv{"recv"}; //Receiving and placing the pieces
+  ThreadRole comp{"comp"}; //Computing
+  ThreadRole proc{"proc"}; //Storing and sending
+};
+
 } // namespace exr
 
 #endif // EXR_UTIL_TYPEDEF_HH_
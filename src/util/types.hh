@@ -7,15 +7,23 @@
 
 namespace exr {
 
+const Count kMaxLanes = 4;  // Lost blocks of a stripe repaired together
+
 struct RepairTask {
   Count task_id;
   Count src_num;
   Count tar_id;
-  DataSize offset;      // BANDWIDTH_MESSAGE: =0, set; >0, load
-  DataSize size;        // =0, SPECIAL(end | BANDWIDTH_MESSAGE)
-  DataSize piece_size;  // SPECIAL: =0, end; >0, BANDWIDTH_MESSAGE
+  DataSize offset;
+  DataSize size;
+  DataSize piece_size;
   RSUnit coef;
-  BwType bandwidth;     // BANDWIDTH_MESSAGE: =0, set_full
+  BwType bandwidth;
+  Count lane_num = 1;                //Lost blocks repaired, one lane each
+  RSUnit lane_coefs[kMaxLanes - 1] = {}; //coef of lanes 1, 2, ...
+
+  RSUnit GetCoef(const Count &lane) const {
+    return lane == 0 ? coef : lane_coefs[lane - 1];
+  }
 
   void show() const {
     std::cout << std::endl
@@ -25,18 +33,23 @@ struct RepairTask {
               << "offset:    " << offset << std::endl
               << "size:      " << size << std::endl
               << "psize:     " << piece_size << std::endl
-              << "coef:      " << static_cast<int>(coef) << std::endl
+              << "coef:      " << static_cast<int>(coef);
+    for (Count l = 1; l < lane_num; ++l)
+      std::cout << " " << static_cast<int>(GetCoef(l));
+    std::cout << std::endl
               << "bandwidth: " << bandwidth << std::endl;
   }
 };
 
 struct ReceiveTask {
-  RepairTask rt;
+  RepairTask rt;        // rt.size =0, keep receiving from the stream
   Count src_id;
+  Count stream;
 
   void show() const {
     rt.show();
-    std::cout << "src_id:    " << src_id << std::endl;
+    std::cout << "src_id:    " << src_id << std::endl
+              << "stream:    " << stream << std::endl;
   }
 };
 
@@ -48,6 +61,11 @@ struct DataPiece {  // *  MESSAGE  *         LOCAL         *  NETWORK  * //
   Count tar_id;     // *     0     *       target_id       *     0     * //
   Count src_num;    // *     0     *        src_num        *     0     * //
   TTime delay_time; // *     0     *       delaytime       *     0     * //
+  Count src_id;     // *     0     *           0           *   src_id  * //
+  RSUnit coef = 1;  // *     1     *   coef    |     1     *     1     * //
+  Count lane = 0;   // *     0     *   lane    |     0     *   lane    * //
+                    // coef: the content is to be multiplied by it
+                    // lane: which of the lost blocks it is a part of
 
   void show() const {
     std::cout << std::endl
@@ -65,6 +83,19 @@ struct DataPiece {  // *  MESSAGE  *         LOCAL         *  NETWORK  * //
   }
 };
 
+struct PieceHeader {  // Sent before the content of each piece on the wire
+  Count task_id;
+  DataSize offset;
+  DataSize size;
+  DataSize length;     // Size of the content on the wire, =0, not compressed
+  Count lane = 0;
+};
+
+struct Traffic {  // Reported by the nodes to the master
+  uint64_t sent;
+  uint64_t received;
+};
+
 } // namespace exr
 
 #endif // EXR_UTIL_TYPES_HH_
@@ -31,6 +31,20 @@ template <typename Data> Data WaitingQueue<Data>::Pop() {
   }
 }
 
+//Get the earliest ones under one lock
+template <typename Data>
+size_t WaitingQueue<Data>::PopBatch(Data *out, const size_t &max_n) {
+  std::unique_lock<std::mutex> lck(mtx_);
+  cv_.wait(lck, [&] { return close_flag_ || !data_queue_.empty(); });
+  if (close_flag_) return 0;
+  size_t n = 0;
+  for (; n < max_n && !data_queue_.empty(); ++n) {
+    out[n] = std::move(data_queue_.front());
+    data_queue_.pop();
+  }
+  return n;
+}
+
 //Close and wake up waiting threads
 template <typename Data> void WaitingQueue<Data>::Close() {
   std::unique_lock<std::mutex> lck(mtx_);
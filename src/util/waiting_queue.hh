@@ -2,6 +2,7 @@
 #define EXR_UTIL_WAITINGQUEUE_HH_
 
 #include <condition_variable>
+#include <cstddef>
 #include <mutex>
 #include <queue>
 
@@ -18,6 +19,9 @@ class WaitingQueue
   //Store and get data
   void Push(Data data);
   Data Pop();
+  //Wait for one data, then take at most max_n - 1 more which are ready,
+  //    return the number taken, 0 after closed
+  size_t PopBatch(Data *out, const size_t &max_n);
 
   //Wake up all the waiting threads
   void Close();